@@ -16,6 +16,7 @@ set(abcc_driver_SRCS
    ${ABCC_DRIVER_DIR}/src/abcc_segmentation.c
    ${ABCC_DRIVER_DIR}/src/abcc_setup.c
    ${ABCC_DRIVER_DIR}/src/abcc_timer.c
+   ${ABCC_DRIVER_DIR}/src/abcc_trace.c
    ${ABCC_DRIVER_DIR}/src/par/abcc_handler_parallel.c
    ${ABCC_DRIVER_DIR}/src/par/abcc_parallel_driver.c
    ${ABCC_DRIVER_DIR}/src/serial/abcc_crc16.c
@@ -41,6 +42,7 @@ set(abcc_driver_INCS
    ${ABCC_DRIVER_DIR}/inc/abcc_log.h
    ${ABCC_DRIVER_DIR}/inc/abcc_message.h
    ${ABCC_DRIVER_DIR}/inc/abcc_port.h
+   ${ABCC_DRIVER_DIR}/inc/abcc_trace.h
    ${ABCC_DRIVER_DIR}/src/abcc_command_sequencer.h
    ${ABCC_DRIVER_DIR}/src/abcc_driver_interface.h
    ${ABCC_DRIVER_DIR}/src/abcc_handler.h
@@ -94,4 +96,21 @@ list(APPEND ABCC_DRIVER_INCLUDE_DIRS
 target_include_directories(abcc_driver PRIVATE ${ABCC_DRIVER_INCLUDE_DIRS})
 
 # Link the Anybus CompactCom Driver library to the Anybus CompactCom API library.
-target_link_libraries(abcc_driver abcc_abp)
\ No newline at end of file
+target_link_libraries(abcc_driver abcc_abp)
+
+# Generates the ADI entry list, the default map and the process data layout
+# constants from a JSON ADI description with tools/abcc_adi_gen.py, and adds the
+# generated files to <target>. <output> is the path of the generated files
+# without extension.
+function(abcc_generate_adi_tables target description output)
+   find_package(Python3 REQUIRED COMPONENTS Interpreter)
+   add_custom_command(
+      OUTPUT ${output}.c ${output}.h
+      COMMAND ${Python3_EXECUTABLE} ${ABCC_DRIVER_DIR}/tools/abcc_adi_gen.py ${description} -o ${output}
+      DEPENDS ${description} ${ABCC_DRIVER_DIR}/tools/abcc_adi_gen.py
+      COMMENT "Generating ADI tables from ${description}"
+   )
+   get_filename_component(output_dir ${output} DIRECTORY)
+   target_sources(${target} PRIVATE ${output}.c ${output}.h)
+   target_include_directories(${target} PRIVATE ${output_dir})
+endfunction()
\ No newline at end of file
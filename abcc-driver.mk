@@ -26,6 +26,7 @@ SRCS += $(ABCC_DRIVER_DIR)/src/abcc_remap.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_segmentation.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_setup.c
 SRCS += $(ABCC_DRIVER_DIR)/src/abcc_timer.c
+SRCS += $(ABCC_DRIVER_DIR)/src/abcc_trace.c
 SRCS += $(ABCC_DRIVER_DIR)/src/par/abcc_handler_parallel.c
 SRCS += $(ABCC_DRIVER_DIR)/src/par/abcc_parallel_driver.c
 SRCS += $(ABCC_DRIVER_DIR)/src/serial/abcc_crc16.c
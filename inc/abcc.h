@@ -260,6 +260,36 @@ EXTFUNC void ABCC_RunTimerSystem( const INT16 iDeltaTimeMs );
 */
 EXTFUNC UINT64 ABCC_GetUptimeMs( void );
 
+/*------------------------------------------------------------------------------
+** Returns the uptime of the driver in microseconds. The resolution is one
+** millisecond unless the port defines ABCC_PORT_GetMonotonicTimeUs, see
+** abcc_port.h.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Uptime of the driver in microseconds.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT64 ABCC_GetUptimeUs( void );
+
+/*------------------------------------------------------------------------------
+** Returns the time until the next driver timer expires. Can be used by a
+** tickless application to decide when ABCC_RunTimerSystem() has to be called
+** next.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Milliseconds until the next timer expires, 0 if a timer is already due.
+**    ABCC_TIMER_NO_DEADLINE if no timer is running.
+**------------------------------------------------------------------------------
+*/
+#define ABCC_TIMER_NO_DEADLINE ( 0xFFFFFFFFUL )
+EXTFUNC UINT32 ABCC_GetTimerNextDeadlineMs( void );
+
 /*------------------------------------------------------------------------------
 ** ABCC hardware reset.
 ** Note! This function will only set reset pin to low. It the responsibility of
@@ -406,9 +436,153 @@ EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_Ms
                                                                     const void* pxObject );
 
 /*------------------------------------------------------------------------------
-** Sends a remap response to the ABCC. When the response is sent the new process
-** data sizes will be set and the function ABCC_CbfRemapDone() will be called to
-** indicate the change.
+** Sends a segmented response message to the ABCC, gathering the data from a
+** list of source regions. The regions are sent in order as if they were one
+** buffer, so data spread over several places does not have to be assembled by
+** the caller first.
+** When the regions are exhausted pnNext, if supplied, is called for further
+** blocks. To keep slow data sources, e.g. flash reads, from stalling the
+** message handling:
+** - pnNext is called ahead of time, as soon as the current block fits in the
+**   next segment, so the next block can be fetched while the current segment
+**   is in flight. The block returned must therefore not reuse the memory of
+**   the previous block, i.e. two buffers are needed.
+** - pnNext may start the fetch and return NULL with the size set to
+**   ABCC_SEG_BLOCK_PENDING. The block is then supplied later by calling
+**   ABCC_SegmentationBlockReady(), and the session waits for it without
+**   blocking the driver.
+** The regions must be valid until pnDone has been called. The list itself
+** is referenced, not copied, and must also remain valid.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psReqMsgHeader - Pointer to request message header.
+**    bRspCmdExt0    - Value of command extension 0 to use in response segments.
+**    pasIoVec       - Pointer to list of source regions.
+**    bNumIoVec      - Number of source regions.
+**    pnNext         - Callback to request the next data block when the
+**                     regions are exhausted. NULL if all data is supplied in
+**                     the regions.
+**    pnDone         - Callback to indicate that the entire message is sent.
+**    pxObject       - User defined object. Forwarded as parameter in pnDone and
+**                     pnNext callback functions. Also identifies the session
+**                     in ABCC_SegmentationBlockReady().
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSessionIoVec( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                         UINT8 bRspCmdExt0,
+                                                                         const ABCC_SegIoVecType* pasIoVec,
+                                                                         UINT8 bNumIoVec,
+                                                                         ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                                         ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                         const void* pxObject );
+
+/*------------------------------------------------------------------------------
+** Supplies a data block that the pnNext callback of a segmentation session
+** reported as ABCC_SEG_BLOCK_PENDING. If the session is waiting for the block
+** the next segment is sent from this call. Must not be called from interrupt
+** context.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pxObject - User defined object of the session.
+**    pxData   - Pointer to the data block. NULL if there is no more data.
+**    lSize    - Size of the data block in octets.
+**
+** Returns:
+**    ABCC_EC_NO_ERROR if the block was accepted.
+**    ABCC_EC_PARAMETER_NOT_VALID if no session is waiting for a block.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_SegmentationBlockReady( const void* pxObject,
+                                                        const void* pxData,
+                                                        UINT32 lSize );
+
+/*------------------------------------------------------------------------------
+** Sends a command with more data than fits in one message as a chain of
+** segmented commands to the ABCC.
+** The data is supplied in the same way as for
+** ABCC_StartServerRespSegmentationSession(), either as one buffer, by the
+** pnNext callback, or as a combination of both. Each segment is filled up to
+** ABCC_GetMaxMessageSize() and sent with a new source ID. The next segment is
+** sent when the response to a previous segment has been received.
+** Up to bMaxSegmentsInFlight segments, but never more than
+** ABCC_CFG_MAX_NUM_APPL_CMDS, are sent without waiting for their responses.
+** Use 1 unless the destination object is known to accept further segments
+** before the previous one has been responded to.
+** The session ends when the last segment has been responded to, or when an
+** error response is received, and pnDone is then called.
+** The data buffers must be valid until pnDone has been called.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdMsgHeader       - Pointer to header with destination object,
+**                           instance, command and command extension 0 to use
+**                           in every segment. Other fields are not used.
+**    pxData               - Pointer to first message payload block.
+**    lSize                - Size of first payload block.
+**    pnNext               - Callback to request the next data block.
+**                           NULL if all data is supplied in pxData.
+**    pnDone               - Callback to indicate that the session has ended.
+**    bMaxSegmentsInFlight - Maximum number of segments waiting for a response.
+**                           Fewer are sent while the command queue is used
+**                           by other commands.
+**    pxObject             - User defined object. Forwarded as parameter in
+**                           pnDone and pnNext callback functions.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_StartClientCmdSegmentationSession( const ABP_MsgHeaderType* psCmdMsgHeader,
+                                                                   const void* pxData,
+                                                                   UINT32 lSize,
+                                                                   ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                                   ABCC_SegClientMsgHandlerDoneFuncType pnDone,
+                                                                   UINT8 bMaxSegmentsInFlight,
+                                                                   const void* pxObject );
+
+/*------------------------------------------------------------------------------
+** Receives a segmented command from the ABCC.
+** Called from ABCC_CbfHandleCommandMessage() when a command with the
+** ABP_MSG_CMDEXT1_SEG_FIRST bit set is received. The driver then takes care of
+** this and the following segments of the command and responds to each segment
+** except the last one.
+** The segment data is either passed to pnSink as each segment arrives, so that
+** no buffer for the complete command is needed, or copied to pxBuffer. If
+** pnSink is supplied pxBuffer is not used.
+** When the last segment has been received pnDone is called with that segment.
+** The application shall then respond to it as to any other command.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg       - Pointer to the first segment of the command.
+**    pxBuffer    - Buffer to store the command data in. Not used if pnSink is
+**                  supplied.
+**    lBufferSize - Size of pxBuffer in octets. If the command holds more data
+**                  the session is ended with an error response.
+**    pnSink      - Callback receiving the data of each segment.
+**                  NULL if the data shall be stored in pxBuffer.
+**    pnDone      - Callback to indicate that the command has been received.
+**    pxObject    - User defined object. Forwarded as parameter in pnSink and
+**                  pnDone callback functions.
+**
+** Returns:
+**    ABCC_ErrorCodeType. If an error is returned the command is not handled by
+**    the driver and the application has to respond to it.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_StartServerCmdReassemblySession( ABP_MsgType* psMsg,
+                                                                 void* pxBuffer,
+                                                                 UINT32 lBufferSize,
+                                                                 ABCC_SegMsgHandlerSinkFuncType pnSink,
+                                                                 ABCC_SegReassemblyDoneFuncType pnDone,
+                                                                 const void* pxObject );
+
+/*------------------------------------------------------------------------------
+** Sends a remap response to the ABCC. The new process data sizes are prepared
+** in advance and the driver switches to them on the frame boundary where the
+** response has been sent, process data before that boundary uses the current
+** sizes. ABCC_CbfRemapDone() is then called to indicate the change.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    psMsgResp       - Pointer to the response message.
@@ -554,6 +728,41 @@ EXTFUNC BOOL ABCC_ModuleDetect( void );
 EXTFUNC UINT16 ABCC_ModCap( void );
 #endif
 
+#if ABCC_CFG_DRV_PARALLEL_ENABLED && ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+/*------------------------------------------------------------------------------
+** Registers a byte range of the read process data that is used by the
+** application. Once at least one range is registered, only the registered
+** ranges are read from the ABCC in parallel operating mode. The content of the
+** read process data buffer outside the registered ranges is undefined.
+** Ranges are extended to 16 bit boundaries, and adjacent or overlapping ranges
+** are merged. See ABCC_CFG_PAR_RDPD_RANGES_ENABLED.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iOffset - Offset of the range in the read process data in octets.
+**    iSize   - Size of the range in octets.
+**
+** Returns:
+**    ABCC_EC_NO_ERROR
+**    ABCC_EC_PARAMETER_NOT_VALID - The range is empty or outside
+**                                  ABCC_CFG_MAX_PROCESS_DATA_SIZE.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_AddReadPdRange( UINT16 iOffset, UINT16 iSize );
+
+/*------------------------------------------------------------------------------
+** Removes all registered read process data ranges. The complete read process
+** data is read again.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_ClearReadPdRanges( void );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Reads the LED status. Only supported in SPI and parallel operating mode.
 **------------------------------------------------------------------------------
@@ -681,6 +890,42 @@ EXTFUNC ABCC_NetFormatType ABCC_NetFormat( void );
 */
 EXTFUNC ABCC_ParameterSupportType ABCC_ParameterSupport( void );
 
+/*------------------------------------------------------------------------------
+** Finds the index of an ADI instance in the ADI table returned by
+** ABCC_CbfAdiMappingReq(). The driver builds an instance index when
+** ABCC_CbfAdiMappingReq() returns, making the lookup O(1) (see
+** ABCC_CFG_ADI_INDEX_SIZE). Without the index the ADI table is binary searched
+** if it is sorted by instance number, otherwise linearly searched.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iInstance - ADI instance number.
+**
+** Returns:
+**    Index in the ADI table. AD_INVALID_ADI_INDEX if the instance doesn't
+**    exist or ABCC_CbfAdiMappingReq() has not been called yet.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_GetAdiIndex( UINT16 iInstance );
+
+/*------------------------------------------------------------------------------
+** Finds the bit offset of an element within the value of an ADI in the ADI
+** table returned by ABCC_CbfAdiMappingReq(). The bit offset of element
+** bNumOfElements is the total size of the ADI. For structured ADIs the offsets
+** are taken from a table built by the driver (see
+** ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE), which gives the size of any element
+** range in constant time.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iAdiIndex  - Index in the ADI table (see ABCC_GetAdiIndex()).
+**    iElemIndex - Element index, 0 to bNumOfElements. Larger values are
+**                 treated as bNumOfElements.
+**
+** Returns:
+**    Bit offset of the element. 0 if the ADI index is not valid.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_GetAdiElementBitOffset( UINT16 iAdiIndex, UINT16 iElemIndex );
+
 /*------------------------------------------------------------------------------
 ** This function will call ABCC_HAL_GetOpmode() to read the operating mode from
 ** HW. If the operation is known and fixed or in any other way decided by the
@@ -779,6 +1024,33 @@ EXTFUNC void ABCC_CbfUserInitReq( void );
 */
 EXTFUNC void ABCC_CbfHandleCommandMessage( ABP_MsgType* psReceivedMsg );
 
+#if ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
+/*------------------------------------------------------------------------------
+** A response message has been received from the ABCC in memory mapped parallel
+** operating mode. The message is located in the read message area of the ABCC
+** and is offered to the application before it is copied to a message buffer.
+** The message must not be modified and is only valid until this function
+** returns. The message must not be passed to any driver function that takes
+** a message buffer, e.g. ABCC_TakeMsgBufferOwnership() or ABCC_SendCmdMsg().
+**
+** Return TRUE only for responses the application recognizes as its own (e.g.
+** by source ID) and has completely handled. The response handler registered in
+** ABCC_SendCmdMsg() is then released without being called. Return FALSE for
+** all other responses, these are copied to a message buffer and routed to the
+** registered response handler as usual.
+** Regarding callback context, see comment for callback section above.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psReceivedMsg       - Pointer to received response message (read-only).
+**
+** Returns:
+**    TRUE  - The response is handled, release it.
+**    FALSE - The response shall be handled by the registered response handler.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_CbfHandleResponseInPlace( const ABP_MsgType* psReceivedMsg );
+#endif
+
 /*------------------------------------------------------------------------------
 ** This function needs to be implemented by the application. The function
 ** updates the current write process data. The data must be copied into the
@@ -47,6 +47,11 @@ typedef enum
 #define AD_MAP_ALL_ELEM          0
 #define AD_MAP_PAD_ADI           0
 
+/*
+** Invalid ADI index, see ABCC_GetAdiIndex().
+*/
+#define AD_INVALID_ADI_INDEX     0xFFFF
+
 typedef struct AD_Map
 {
   UINT16     iInstance;
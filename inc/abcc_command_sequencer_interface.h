@@ -27,17 +27,48 @@
 **    ABCC_CMD_SEQ_END()
 ** };
 **
+** A step defined with ABCC_CMD_SEQ_INDEPENDENT() does not depend on the
+** responses of the preceding steps and may be sent while they are still
+** outstanding (see ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT). The next step defined with
+** ABCC_CMD_SEQ() waits until all outstanding responses have been received.
+** Example, CmdBuilder2 and CmdBuilder3 are sent right after CmdBuilder1 and
+** CmdBuilder4 is sent when all three responses have been handled:
+** static const ABCC_CmdSeqType ExampleSequence[] =
+** {
+**    ABCC_CMD_SEQ(             CmdBuilder1, RespHandler1 ),
+**    ABCC_CMD_SEQ_INDEPENDENT( CmdBuilder2, RespHandler2 ),
+**    ABCC_CMD_SEQ_INDEPENDENT( CmdBuilder3, RespHandler3 ),
+**    ABCC_CMD_SEQ(             CmdBuilder4, RespHandler4 ),
+**    ABCC_CMD_SEQ_END()
+** };
+**
+** ABCC_CMD_SEQ_TMO() and ABCC_CMD_SEQ_INDEPENDENT_TMO() add a response timeout
+** in ms and a number of retries to the step (see
+** ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED). The command is built and sent again
+** when the timeout expires, the timeout is doubled for each retry. When no
+** retries are left the sequence ends with ABCC_CMDSEQ_RESULT_TIMEOUT.
+** Example, CmdBuilder1 waits 100, 200 and 400 ms for a response:
+**    ABCC_CMD_SEQ_TMO( CmdBuilder1, RespHandler1, 100, 2 ),
+**
 */
+#define ABCC_CMD_SEQ_FLAG_INDEPENDENT  0x01
+
 #if ABCC_CFG_DEBUG_CMD_SEQ_ENABLED
-#define ABCC_CMD_SEQ( cmd, resp ) { cmd, resp, #cmd, #resp }
+#define ABCC_CMD_SEQ( cmd, resp ) { cmd, resp, #cmd, #resp, 0, 0, 0 }
+#define ABCC_CMD_SEQ_INDEPENDENT( cmd, resp ) { cmd, resp, #cmd, #resp, ABCC_CMD_SEQ_FLAG_INDEPENDENT, 0, 0 }
+#define ABCC_CMD_SEQ_TMO( cmd, resp, tmo, retries ) { cmd, resp, #cmd, #resp, 0, tmo, retries }
+#define ABCC_CMD_SEQ_INDEPENDENT_TMO( cmd, resp, tmo, retries ) { cmd, resp, #cmd, #resp, ABCC_CMD_SEQ_FLAG_INDEPENDENT, tmo, retries }
 #else
-#define ABCC_CMD_SEQ( cmd, resp ) { cmd, resp }
+#define ABCC_CMD_SEQ( cmd, resp ) { cmd, resp, 0, 0, 0 }
+#define ABCC_CMD_SEQ_INDEPENDENT( cmd, resp ) { cmd, resp, ABCC_CMD_SEQ_FLAG_INDEPENDENT, 0, 0 }
+#define ABCC_CMD_SEQ_TMO( cmd, resp, tmo, retries ) { cmd, resp, 0, tmo, retries }
+#define ABCC_CMD_SEQ_INDEPENDENT_TMO( cmd, resp, tmo, retries ) { cmd, resp, ABCC_CMD_SEQ_FLAG_INDEPENDENT, tmo, retries }
 #endif
 
 #if ABCC_CFG_DEBUG_CMD_SEQ_ENABLED
-#define ABCC_CMD_SEQ_END()    { NULL, NULL, NULL, NULL }
+#define ABCC_CMD_SEQ_END()    { NULL, NULL, NULL, NULL, 0, 0, 0 }
 #else
-#define ABCC_CMD_SEQ_END()    { NULL, NULL }
+#define ABCC_CMD_SEQ_END()    { NULL, NULL, 0, 0, 0 }
 #endif
 
 /*
@@ -74,7 +105,8 @@ typedef enum ABCC_CmdSeqResult
 {
    ABCC_CMDSEQ_RESULT_COMPLETED,
    ABCC_CMDSEQ_RESULT_ABORT_INT,
-   ABCC_CMDSEQ_RESULT_ABORT_EXT
+   ABCC_CMDSEQ_RESULT_ABORT_EXT,
+   ABCC_CMDSEQ_RESULT_TIMEOUT
 }
 ABCC_CmdSeqResultType;
 
@@ -143,6 +175,9 @@ typedef struct ABCC_CmdSeq
    char*                   pcCmdName;
    char*                   pcRespName;
 #endif
+   UINT8                   bFlags;
+   UINT16                  iTimeoutMs;    /* Response timeout, 0 if none */
+   UINT8                   bNumRetries;   /* Retries when timeout expires */
 }
 ABCC_CmdSeqType;
 
@@ -160,6 +195,12 @@ ABCC_CmdSeqType;
 ** be executed. The last entry in the array is indicated by NULL pointers.
 ** The next command in the sequence will be executed when the previous command
 ** has successfully received a response.
+** Steps defined with ABCC_CMD_SEQ_INDEPENDENT() are exceptions, they are
+** executed without waiting for the outstanding responses, up to
+** ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT commands at a time and as long as there are
+** free entries in the command queue (see ABCC_GetCmdQueueSize()). If a
+** response handler of such a step returns ABCC_CMDSEQ_RESP_EXEC_CURRENT, only
+** that step is executed again.
 **
 ** If a command sequence response handler exists the response will be passed to
 ** the application.
@@ -171,6 +212,11 @@ ABCC_CmdSeqType;
 ** If the pnCmdSeqDone function callback exists the application will be
 ** notified when the whole command sequence has finished.
 **
+** If a step has a response timeout (see ABCC_CMD_SEQ_TMO()) and
+** ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED is set, the step is retried when the
+** timeout expires and the sequence is ended with ABCC_CMDSEQ_RESULT_TIMEOUT
+** when all retries have timed out.
+**
 ** The number of concurrent command sequences is limited by
 ** ABCC_CFG_MAX_NUM_CMD_SEQ defined in abcc_driver_config.h.
 **
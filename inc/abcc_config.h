@@ -282,6 +282,85 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #endif
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_PAR_REG_SHADOW_ENABLED  1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Enable/disable shadowing of the parallel interface status registers. If
+** enabled, the buffer control and Anybus status registers are read once in a
+** single burst at the start of each ABCC_RunDriver() cycle, and the interrupt
+** status register at its first use in the cycle. The driver then uses the
+** shadow values for the rest of the cycle instead of reading the registers
+** over the external bus every time they are needed. A shadow is invalidated
+** when the driver writes the register, when ABCC_ISR() is called and at the
+** end of the cycle, so outside ABCC_RunDriver() the registers are always read
+** directly.
+**
+** Events that occur during a cycle are detected in the next cycle.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_PAR_REG_SHADOW_ENABLED
+    #define ABCC_CFG_PAR_REG_SHADOW_ENABLED 0
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED  1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Enable/disable in-place access to received response messages. Requires
+** ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED. If enabled, each received response
+** message is first offered to ABCC_CbfHandleResponseInPlace() as a read-only
+** view of the read message area of the ABCC. If the application handles the
+** response there, the read message area is released to the ABCC without
+** allocating a message buffer or copying the message. Otherwise the message
+** is copied to a message buffer in one copy and handled as usual.
+**
+** If 1, the ABCC_CbfHandleResponseInPlace() function must be implemented by
+** the application.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
+    #define ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED 0
+#endif
+
+#if ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED && !ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED
+    #error "ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED requires ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED."
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_PAR_RDPD_RANGES_ENABLED  1 - Enable / 0 - Disable
+** #define ABCC_CFG_PAR_MAX_NUM_RDPD_RANGES              ( 8 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Enable/disable partial read of the read process data in parallel operating
+** mode. If enabled, the application can register the byte ranges of the read
+** process data it uses with ABCC_AddReadPdRange(), typically the ranges of the
+** mapped ADIs it consumes. The driver then only reads those ranges from the
+** ABCC, adjacent and overlapping ranges are merged into one read. If no range
+** is registered the complete read process data is read.
+**
+** ABCC_CFG_PAR_MAX_NUM_RDPD_RANGES is the maximum number of separate ranges.
+** If more separate ranges are registered, the two ranges with the smallest gap
+** between them are merged.
+**
+** Only applicable if ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED is 0, a memory
+** mapped read process data is accessed in place.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+    #define ABCC_CFG_PAR_RDPD_RANGES_ENABLED 0
+#endif
+#ifndef ABCC_CFG_PAR_MAX_NUM_RDPD_RANGES
+    #define ABCC_CFG_PAR_MAX_NUM_RDPD_RANGES ( 8 )
+#endif
+
+#if ABCC_CFG_PAR_RDPD_RANGES_ENABLED && ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED
+    #error "ABCC_CFG_PAR_RDPD_RANGES_ENABLED is not applicable when ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED is enabled."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_SERIAL_TMO_19_2                      ( 350 )
 ** #define ABCC_CFG_SERIAL_TMO_57_6                      ( 120 )
@@ -322,6 +401,72 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_SERIAL_TMO_625 ( 20 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_SERIAL_CRC_FAST_TABLE_ENABLED  1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** There are two versions of the serial CRC16 algorithm implemented. The
+** default one processes one byte per iteration using two 256 byte tables. The
+** fast one processes four bytes per iteration using four 256 entry tables.
+** The fast table is typically considerably faster on large telegrams but will
+** consume more memory (2048 bytes vs 512 bytes). Configure this based on
+** performance needs vs available memory.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_SERIAL_CRC_FAST_TABLE_ENABLED
+    #define ABCC_CFG_SERIAL_CRC_FAST_TABLE_ENABLED 0
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED  1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Enable/disable calculation of the RX telegram CRC while the telegram is
+** being received. The hardware abstraction layer reports each received chunk
+** of the RX telegram and the driver updates the CRC incrementally, so the CRC
+** is ready as soon as the last byte has been received instead of being
+** calculated over the whole telegram afterwards.
+**
+** If 1, the ABCC_HAL_SerRegRxChunkReceived() function must be implemented in
+** the hardware abstraction layer. A hardware abstraction layer that never
+** reports any chunks is still supported, the CRC is then calculated after the
+** complete telegram has been received.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+    #define ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED 0
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED  1 - Enable / 0 - Disable
+** #define ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS           ( 5 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Enable/disable adaptive serial telegram timeout. If enabled, the driver
+** measures the time from sending a ping until the matching pong is received
+** and keeps a smoothed round trip time and round trip time variation
+** (similar to the TCP retransmission timeout, RFC 6298). The telegram timeout
+** is derived from those and is bounded below by
+** ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS and above by the ABCC_CFG_SERIAL_TMO_*
+** value of the selected baudrate. Each telegram timeout doubles the current
+** timeout up to the upper bound.
+**
+** A lost telegram is then detected after a few round trip times instead of
+** after the worst case timeout. The resolution of the measurement is the
+** interval at which ABCC_RunTimerSystem() is called, so the lower bound
+** should be at least a couple of timer ticks.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+    #define ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED 0
+#endif
+#ifndef ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS
+    #define ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS ( 5 )
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_MODULE_ID_PINS_CONN       1 - Enable / 0 - Disable
 **
@@ -398,6 +543,62 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_MAX_MSG_SIZE ( 1524 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MAX_NUM_SEG_SESSIONS               ( 4 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of server response segmentation sessions, started with
+** ABCC_StartServerRespSegmentationSession(), that can be ongoing at the same
+** time. Several sessions are needed if multiple network masters read large
+** attributes concurrently. Each session costs a few tens of bytes of RAM.
+** At least 1 and at most 254 sessions are supported.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MAX_NUM_SEG_SESSIONS
+    #define ABCC_CFG_MAX_NUM_SEG_SESSIONS ( 4 )
+#endif
+
+#if ( ABCC_CFG_MAX_NUM_SEG_SESSIONS < 1 ) || ( ABCC_CFG_MAX_NUM_SEG_SESSIONS > 254 )
+    #error "ABCC_CFG_MAX_NUM_SEG_SESSIONS must be in the range 1 - 254."
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS        ( 1 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of client command segmentation sessions, started with
+** ABCC_StartClientCmdSegmentationSession(), that can be ongoing at the same
+** time.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS
+    #define ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS ( 1 )
+#endif
+
+#if ( ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS < 1 )
+    #error "ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS must be at least 1."
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS        ( 1 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of segmented commands, started with
+** ABCC_StartServerCmdReassemblySession(), that can be received at the same
+** time.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS
+    #define ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS ( 1 )
+#endif
+
+#if ( ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS < 1 )
+    #error "ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS must be at least 1."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN                   0
 **
@@ -657,6 +858,28 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_WD_TIMEOUT_MS ( 1000 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_TIMER_WHEEL_SIZE                   ( 16 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of slots in the timer wheel, must be a power of two. Each slot
+** corresponds to one millisecond. Running timers are kept in the slot of their
+** expiry time so each timer tick only needs to look at the slots for the
+** elapsed time. Timers expiring further ahead than the wheel size stay in
+** their slot until the wheel has turned enough times. A larger wheel gives
+** fewer timers per slot at the cost of two bytes of RAM per slot.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_TIMER_WHEEL_SIZE
+    #define ABCC_CFG_TIMER_WHEEL_SIZE ( 16 )
+#endif
+
+#if ( ( ABCC_CFG_TIMER_WHEEL_SIZE & ( ABCC_CFG_TIMER_WHEEL_SIZE - 1 ) ) != 0 ) || \
+    ( ABCC_CFG_TIMER_WHEEL_SIZE == 0 )
+    #error "ABCC_CFG_TIMER_WHEEL_SIZE must be a power of two."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_REMAP_SUPPORT_ENABLED   1 - Enable / 0 - Disable
 **
@@ -684,6 +907,31 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_STRUCT_DATA_TYPE_ENABLED 0
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE       ( 0 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of UINT16 slots used for the bit offset tables of structured ADIs,
+** which the driver builds when ABCC_CbfAdiMappingReq() returns. One slot is
+** used for each ADI in the ADI table and bNumOfElements + 1 slots for each
+** structured ADI. With a table the size of an element range is found in
+** constant time (see ABCC_GetAdiElementBitOffset()), otherwise the element
+** sizes are summed for each lookup. Structured ADIs that don't fit are looked
+** up without a table.
+** Only used if ABCC_CFG_STRUCT_DATA_TYPE_ENABLED is 1.
+**
+** Default is 0, no tables.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE
+    #define ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE ( 0 )
+#endif
+
+#if ( ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE > 0xFFFF )
+    #error "ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE must not be bigger than 65535."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_ADI_GET_SET_CALLBACK_ENABLED   1 - Enable / 0 - Disable
 **
@@ -744,6 +992,31 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_DOUBLE_ADI_SUPPORT_ENABLED 1
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_ADI_INDEX_SIZE                     ( 0 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Number of UINT16 slots in the ADI instance index, which the driver builds
+** when ABCC_CbfAdiMappingReq() returns and which is used by
+** ABCC_GetAdiIndex(). If the ADI instance numbers span at most this many
+** values the index is a table indexed by instance number. Otherwise, if there
+** are fewer ADIs than slots, it is a hash table. A size of about twice the
+** number of ADIs keeps the hash lookups short.
+** If the index can't be used the ADI table is binary searched, which requires
+** it to be sorted by instance number, or linearly searched if it isn't.
+**
+** Default is 0, no index.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_ADI_INDEX_SIZE
+    #define ABCC_CFG_ADI_INDEX_SIZE ( 0 )
+#endif
+
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0xFFFF )
+    #error "ABCC_CFG_ADI_INDEX_SIZE must not be bigger than 65535."
+#endif
+
 /*------------------------------------------------------------------------------
 ** #define ABCC_CFG_LOG_SEVERITY
 **
@@ -760,6 +1033,59 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_LOG_SEVERITY ABCC_LOG_SEVERITY_ERROR_ENABLED
 #endif
 
+/*------------------------------------------------------------------------------
+** Per part log severity.
+**
+** #define ABCC_CFG_LOG_SEVERITY_LINK           Message queues and flow control
+** #define ABCC_CFG_LOG_SEVERITY_MEMORY         Message buffer allocation
+** #define ABCC_CFG_LOG_SEVERITY_SPI            SPI driver
+** #define ABCC_CFG_LOG_SEVERITY_SERIAL         Serial driver
+** #define ABCC_CFG_LOG_SEVERITY_PARALLEL       Parallel driver
+** #define ABCC_CFG_LOG_SEVERITY_SETUP          Setup sequence
+** #define ABCC_CFG_LOG_SEVERITY_CMD_SEQ        Command sequencer
+** #define ABCC_CFG_LOG_SEVERITY_SEGMENTATION   Message segmentation
+** #define ABCC_CFG_LOG_SEVERITY_TIMER          Timer system
+**
+** Default values below can be overridden in abcc_driver_config.h
+**
+** Overrides ABCC_CFG_LOG_SEVERITY for one part of the driver, using the same
+** ABCC_LOG_SEVERITY_*_ENABLED values. The threshold can be both higher and
+** lower than ABCC_CFG_LOG_SEVERITY, e.g. to get info level logs from the setup
+** sequence without enabling them in the drivers that run for every frame.
+** Log calls above the threshold are removed by the preprocessor, including
+** the evaluation of their arguments. The ABCC_CFG_DEBUG_*_ENABLED printouts
+** also require the threshold of the part making them to be at debug level.
+** The rest of the driver uses ABCC_CFG_LOG_SEVERITY.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_LOG_SEVERITY_LINK
+    #define ABCC_CFG_LOG_SEVERITY_LINK ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_MEMORY
+    #define ABCC_CFG_LOG_SEVERITY_MEMORY ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_SPI
+    #define ABCC_CFG_LOG_SEVERITY_SPI ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_SERIAL
+    #define ABCC_CFG_LOG_SEVERITY_SERIAL ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_PARALLEL
+    #define ABCC_CFG_LOG_SEVERITY_PARALLEL ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_SETUP
+    #define ABCC_CFG_LOG_SEVERITY_SETUP ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_CMD_SEQ
+    #define ABCC_CFG_LOG_SEVERITY_CMD_SEQ ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_SEGMENTATION
+    #define ABCC_CFG_LOG_SEVERITY_SEGMENTATION ABCC_CFG_LOG_SEVERITY
+#endif
+#ifndef ABCC_CFG_LOG_SEVERITY_TIMER
+    #define ABCC_CFG_LOG_SEVERITY_TIMER ABCC_CFG_LOG_SEVERITY
+#endif
+
 /*------------------------------------------------------------------------------
 ** Defines for making the log output more verbose.
 **
@@ -798,6 +1124,61 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_LOG_STRINGS_ENABLED 1
 #endif
 
+/*------------------------------------------------------------------------------
+** Deferred binary logging.
+**
+** #define ABCC_CFG_LOG_BINARY_ENABLED        1 - Enable / 0 - Disable
+**
+** When enabled the log macros do not print anything. Instead a compact record
+** (format string pointer, severity, error code, additional info, timestamp,
+** file/line and the raw arguments) is stored in a ring buffer. The records are
+** formatted and printed when the application calls ABCC_LogFlush() from a low
+** priority context, or fetched with ABCC_LogReadRecord() to be decoded
+** elsewhere. Error reporting via ABCC_CbfDriverError() is still done directly
+** when the log macro is called. Arguments for %s conversions are stored as
+** pointers and must therefore refer to memory that is still valid when the
+** record is printed, which is the case for all log calls made by the driver.
+** The hexdump and message printouts enabled by ABCC_CFG_DEBUG_*_ENABLED are
+** still printed directly.
+**
+** #define ABCC_CFG_LOG_BINARY_NUM_RECORDS    Number of records, power of two
+**
+** Size of the ring buffer. Records logged while the ring buffer is full are
+** dropped and counted, see ABCC_LogGetNumDropped().
+**
+** Records are reserved inside a short critical section. Since the driver logs
+** from within its own critical sections the ABCC_PORT_EnterCritical() and
+** ABCC_PORT_ExitCritical() implementation must support nesting, i.e. restore
+** the previous interrupt state when leaving, see abcc_port.h.
+**
+** #define ABCC_CFG_LOG_BINARY_MAX_ARGS       Number of arguments per record
+**
+** The maximum number of arguments stored per record. Conversions beyond this
+** are printed as the raw conversion specifier.
+**
+** Default values below can be overridden in abcc_driver_config.h
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_LOG_BINARY_ENABLED
+    #define ABCC_CFG_LOG_BINARY_ENABLED 0
+#endif
+#ifndef ABCC_CFG_LOG_BINARY_NUM_RECORDS
+    #define ABCC_CFG_LOG_BINARY_NUM_RECORDS 32
+#endif
+#ifndef ABCC_CFG_LOG_BINARY_MAX_ARGS
+    #define ABCC_CFG_LOG_BINARY_MAX_ARGS 4
+#endif
+
+#if ABCC_CFG_LOG_BINARY_ENABLED
+#if ( ABCC_CFG_LOG_BINARY_NUM_RECORDS < 1 ) || ( ABCC_CFG_LOG_BINARY_NUM_RECORDS > 0x8000 ) || \
+    ( ( ABCC_CFG_LOG_BINARY_NUM_RECORDS & ( ABCC_CFG_LOG_BINARY_NUM_RECORDS - 1 ) ) != 0 )
+    #error "ABCC_CFG_LOG_BINARY_NUM_RECORDS must be a power of two between 1 and 32768."
+#endif
+#if ( ABCC_CFG_LOG_BINARY_MAX_ARGS > 255 )
+    #error "ABCC_CFG_LOG_BINARY_MAX_ARGS must not be bigger than 255."
+#endif
+#endif
+
 /*------------------------------------------------------------------------------
 ** Enable component specifc debug logs.
 **
@@ -843,6 +1224,57 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_DEBUG_CMD_SEQ_ENABLED 0
 #endif
 
+/*------------------------------------------------------------------------------
+** Message and frame trace recorder.
+**
+** #define ABCC_CFG_TRACE_ENABLED             1 - Enable / 0 - Disable
+**
+** Records the same events as the ABCC_CFG_DEBUG_*_ENABLED printouts above
+** (sent and received messages, message queue events, SPI frames and UART
+** telegrams) in binary form in a ring buffer instead of printing them. The
+** recorder is independent of ABCC_CFG_LOG_SEVERITY and cheap enough to be
+** left enabled in the field. The ring buffer is exported with ABCC_TraceDump(),
+** see abcc_trace.h for the capture format.
+**
+** Records are reserved inside a short critical section. Since messages are
+** traced from within the driver's own critical sections the
+** ABCC_PORT_EnterCritical() and ABCC_PORT_ExitCritical() implementation must
+** support nesting, i.e. restore the previous interrupt state when leaving, see
+** abcc_port.h.
+**
+** #define ABCC_CFG_TRACE_NUM_RECORDS         Number of records, power of two
+**
+** Number of records kept. The oldest record is overwritten when the ring
+** buffer is full.
+**
+** #define ABCC_CFG_TRACE_CAPTURE_SIZE        Number of octets
+**
+** Number of octets captured per record. For messages this includes the 12
+** octet message header. Longer messages and frames are truncated.
+**
+** Default values below can be overridden in abcc_driver_config.h
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_TRACE_ENABLED
+    #define ABCC_CFG_TRACE_ENABLED 0
+#endif
+#ifndef ABCC_CFG_TRACE_NUM_RECORDS
+    #define ABCC_CFG_TRACE_NUM_RECORDS 64
+#endif
+#ifndef ABCC_CFG_TRACE_CAPTURE_SIZE
+    #define ABCC_CFG_TRACE_CAPTURE_SIZE 32
+#endif
+
+#if ABCC_CFG_TRACE_ENABLED
+#if ( ABCC_CFG_TRACE_NUM_RECORDS < 1 ) || ( ABCC_CFG_TRACE_NUM_RECORDS > 0x8000 ) || \
+    ( ( ABCC_CFG_TRACE_NUM_RECORDS & ( ABCC_CFG_TRACE_NUM_RECORDS - 1 ) ) != 0 )
+    #error "ABCC_CFG_TRACE_NUM_RECORDS must be a power of two between 1 and 32768."
+#endif
+#if ( ABCC_CFG_TRACE_CAPTURE_SIZE < 12 ) || ( ABCC_CFG_TRACE_CAPTURE_SIZE > 0xFFF0 )
+    #error "ABCC_CFG_TRACE_CAPTURE_SIZE must be between 12 and 65520."
+#endif
+#endif
+
 /*------------------------------------------------------------------------------
 ** Enable fetching and clearing of the Fatal log.
 **
@@ -1048,4 +1480,77 @@ ABCC_CFG_DRV_PARALLEL_ENABLED and ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED are enab
     #define ABCC_CFG_CMD_SEQ_MAX_NUM_RETRIES ( 0 )
 #endif
 
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT     ( UINT8 1-16 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Max number of commands each command sequence may have outstanding at the
+** same time. Steps defined with ABCC_CMD_SEQ_INDEPENDENT() (see
+** abcc_command_sequencer_interface.h) are sent without waiting for the
+** response of the previous steps as long as this window and the command queue
+** (ABCC_GetCmdQueueSize(), see ABCC_CFG_MAX_NUM_APPL_CMDS) allow it. A step
+** defined with ABCC_CMD_SEQ() waits until all outstanding responses have been
+** received. The driver setup sequence uses this for its initial Get_Attribute
+** requests.
+**
+** Default is 4. Set to 1 to execute all steps one at a time.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT
+    #define ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT ( 4 )
+#endif
+
+#if ( ( ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT < 1 ) || ( ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT > 16 ) )
+    #error "ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT must be in the range 1-16."
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED  1 - Enable / 0 - Disable
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Enables the response timeouts of command sequence steps defined with
+** ABCC_CMD_SEQ_TMO() or ABCC_CMD_SEQ_INDEPENDENT_TMO() (see
+** abcc_command_sequencer_interface.h). A step whose response has not been
+** received within its timeout is sent again, with the timeout doubled for
+** each attempt, until its number of retries is used up. The sequence is then
+** ended with ABCC_CMDSEQ_RESULT_TIMEOUT and the source ids of its outstanding
+** commands are released.
+** The command sequencer uses one timer for this, which is included in the
+** default value of ABCC_CFG_MAX_NUM_TIMERS. The timeouts are handled in
+** ABCC_RunDriver().
+**
+** Default is 0. When disabled the timeouts of the steps are ignored.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+    #define ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED ( 0 )
+#endif
+
+/*------------------------------------------------------------------------------
+** #define ABCC_CFG_MAX_NUM_TIMERS                     ( 3 )
+**
+** Default value below can be overridden in abcc_driver_config.h
+**
+** Maximum number of timers that can be created with ABCC_TimerCreate(). The
+** driver itself uses one timer for the startup timeout, one for the SPI or
+** serial watchdog and one for the serial telegram timeout. The default adds
+** one timer if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED is set. Increase the
+** value if the application needs additional timers.
+** At most 254 timers are supported.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_CFG_MAX_NUM_TIMERS
+    #define ABCC_CFG_MAX_NUM_TIMERS ( 3 + ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED )
+#endif
+
+#if ( ABCC_CFG_MAX_NUM_TIMERS > 254 )
+    #error "ABCC_CFG_MAX_NUM_TIMERS must not be bigger than 254."
+#endif
+
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED && ( ABCC_CFG_MAX_NUM_TIMERS < 4 )
+    #error "ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED requires ABCC_CFG_MAX_NUM_TIMERS to be at least 4."
+#endif
+
 #endif  /* inclusion lock */
@@ -56,6 +56,7 @@ typedef enum ABCC_ErrorCodeType
    ABCC_EC_UNKNOWN_ENDIAN = 42,
    ABCC_EC_ASSERT_FAILED = 43,
    ABCC_EC_PD_SIZE_MISMATCH = 44,
+   ABCC_EC_CMD_SEQ_TIMEOUT = 45,
    ABCC_EC_SET_ENUM_ANSI_SIZE       = 0x7FFF
 }
 ABCC_ErrorCodeType;
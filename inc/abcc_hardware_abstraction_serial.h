@@ -34,6 +34,43 @@ typedef void ( *ABCC_HAL_SerDataReceivedCbfType )( void );
 */
 EXTFUNC void ABCC_HAL_SerRegDataReceived( ABCC_HAL_SerDataReceivedCbfType pnDataReceived );
 
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+/*------------------------------------------------------------------------------
+** Function pointer type for RX chunk received callback.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iNumBytesReceived: Total number of bytes of the current RX telegram that
+**                       are stored in the RX buffer so far.
+**------------------------------------------------------------------------------
+*/
+typedef void ( *ABCC_HAL_SerRxChunkReceivedCbfType )( UINT16 iNumBytesReceived );
+
+/*------------------------------------------------------------------------------
+** ABCC_HAL_SerRegRxChunkReceived()
+** Registers a callback function that indicates that a part of the RX telegram
+** has been stored in the buffer provided when ABCC_HAL_SerSendReceive() was
+** called. The driver uses it to calculate the telegram CRC while the telegram
+** is being received.
+** The callback may be called as often as suitable for the hardware, e.g. from
+** the UART RX interrupt or DMA half transfer interrupt. The byte count shall
+** restart from zero after each call to ABCC_HAL_SerSendReceive() or
+** ABCC_HAL_SerRestart(). The callback for the last chunk of the telegram
+** shall be called before the callback registered in
+** ABCC_HAL_SerRegDataReceived().
+** Reporting chunks is optional, if no chunks are reported the CRC is
+** calculated after the complete telegram has been received.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pnRxChunkReceived: Function to call when a part of the RX telegram is
+**                       received.
+**
+** Returns:
+**          -
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_HAL_SerRegRxChunkReceived( ABCC_HAL_SerRxChunkReceivedCbfType pnRxChunkReceived );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Send TX telegram and prepare for RX telegram reception. The the RX telegram
 ** will be stored in the pbRxDataBuffer.
@@ -45,6 +45,17 @@ typedef enum
 }
 ABCC_LogSeverityType;
 
+/*------------------------------------------------------------------------------
+** Severity threshold used by the log macros below. A source file belonging to
+** a driver part with its own threshold (see ABCC_CFG_LOG_SEVERITY_* in
+** abcc_config.h) defines ABCC_LOG_MODULE_SEVERITY to that threshold before
+** including any header. All other files use ABCC_CFG_LOG_SEVERITY.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_LOG_MODULE_SEVERITY
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY
+#endif
+
 /*------------------------------------------------------------------------------
 ** There are a set of macros available to log different severity levels. One
 ** macro for each severity level is available. Depending on the severity the
@@ -65,38 +76,40 @@ ABCC_LogSeverityType;
 **   ABCC_LOG_DEBUG( "Debug event %d", 5 );
 **
 ** See ABCC_CFG_LOG_* in abcc_config.h for details on how to enable logging
-** for different severities and how to customize log prints.
+** for different severities and how to customize log prints. Log calls above
+** the severity threshold are removed by the preprocessor, arguments included.
+** Fatal and error events are still reported to ABCC_CbfDriverError().
 **------------------------------------------------------------------------------
 */
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_FATAL_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_FATAL_ENABLED
 #define ABCC_LOG_FATAL( eErrorCode, lAdditionalInfo, ... ) \
    ABCC_LogHandlerWrapper( ABCC_LOG_SEVERITY_FATAL, eErrorCode, lAdditionalInfo, __VA_ARGS__ )
 #else
 #define ABCC_LOG_FATAL( eErrorCode, lAdditionalInfo, ... ) ABCC_LogError( ABCC_LOG_SEVERITY_FATAL, eErrorCode, lAdditionalInfo )
 #endif
 
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_ERROR_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_ERROR_ENABLED
 #define ABCC_LOG_ERROR( eErrorCode, lAdditionalInfo, ... ) \
    ABCC_LogHandlerWrapper( ABCC_LOG_SEVERITY_ERROR, eErrorCode, lAdditionalInfo, __VA_ARGS__ )
 #else
 #define ABCC_LOG_ERROR( eErrorCode, lAdditionalInfo, ... ) ABCC_LogError( ABCC_LOG_SEVERITY_ERROR, eErrorCode, lAdditionalInfo )
 #endif
 
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
 #define ABCC_LOG_WARNING( eErrorCode, lAdditionalInfo, ... ) \
    ABCC_LogHandlerWrapper( ABCC_LOG_SEVERITY_WARNING, eErrorCode, lAdditionalInfo, __VA_ARGS__ )
 #else
 #define ABCC_LOG_WARNING( ... )
 #endif
 
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_INFO_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_INFO_ENABLED
 #define ABCC_LOG_INFO( ... ) \
    ABCC_LogHandlerWrapper( ABCC_LOG_SEVERITY_INFO, ABCC_EC_NO_ERROR, 0, __VA_ARGS__ )
 #else
 #define ABCC_LOG_INFO( ... )
 #endif
 
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
 #define ABCC_LOG_DEBUG( ... ) \
    ABCC_LogHandlerWrapper( ABCC_LOG_SEVERITY_DEBUG, ABCC_EC_NO_ERROR, 0, __VA_ARGS__ )
 #else
@@ -109,7 +122,7 @@ ABCC_LogSeverityType;
 #define ABCC_LOG_DEBUG_CMD_SEQ( ... )
 #endif
 
-#if ABCC_CFG_DEBUG_MESSAGING_ENABLED && ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
+#if ABCC_CFG_DEBUG_MESSAGING_ENABLED && ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
 #define ABCC_LOG_DEBUG_MSG_CONTENT( psMsg, ... )  \
 do                                                \
 {                                                 \
@@ -129,7 +142,7 @@ do                                             \
 #define ABCC_LOG_DEBUG_MSG_GENERAL( ... )
 #endif
 
-#if ABCC_CFG_DEBUG_HEXDUMP_MSG_ENABLED && ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
+#if ABCC_CFG_DEBUG_HEXDUMP_MSG_ENABLED && ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
 #define ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psMsg )                 \
 do                                                             \
 {                                                              \
@@ -147,7 +160,7 @@ do                                                             \
 #define ABCC_LOG_DEBUG_HEXDUMP_MSG_RX( psMsg )
 #endif
 
-#if ABCC_CFG_DEBUG_HEXDUMP_UART_ENABLED && ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
+#if ABCC_CFG_DEBUG_HEXDUMP_UART_ENABLED && ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
 #define ABCC_LOG_DEBUG_UART_HEXDUMP_TX( pbData, iSizeInBytes ) \
 do                                                             \
 {                                                              \
@@ -165,7 +178,7 @@ do                                                             \
 #define ABCC_LOG_DEBUG_UART_HEXDUMP_RX( pbData, iSizeInBytes )
 #endif
 
-#if ABCC_CFG_DEBUG_HEXDUMP_SPI_ENABLED && ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
+#if ABCC_CFG_DEBUG_HEXDUMP_SPI_ENABLED && ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
 #define ABCC_LOG_DEBUG_SPI_HEXDUMP_MOSI( pbData, iSizeInWords ) \
 do                                                              \
 {                                                               \
@@ -183,7 +196,7 @@ do                                                              \
 #define ABCC_LOG_DEBUG_SPI_HEXDUMP_MISO( pbData, iSizeInBytes )
 #endif
 
-#if ABCC_LOG_DEBUG_MEMORY_ENABLED && ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
+#if ABCC_LOG_DEBUG_MEMORY_ENABLED && ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_DEBUG_ENABLED
 #define ABCC_LOG_DEBUG_MEM( ... ) ABCC_LOG_DEBUG( __VA_ARGS__ )
 #else
 #define ABCC_LOG_DEBUG_MEM( ... )
@@ -265,4 +278,105 @@ EXTFUNC void ABCC_LogHexdumpUart( UINT8* pbData, UINT16 iSizeInBytes, BOOL fTx )
 EXTFUNC void ABCC_LogHexdumpMsg( ABP_MsgType* psMsg, BOOL fTx );
 #endif
 
+#if ABCC_CFG_LOG_BINARY_ENABLED
+/*------------------------------------------------------------------------------
+** Stored argument of a binary log record. The member holding the value is
+** given by the corresponding conversion specification in the format string.
+**------------------------------------------------------------------------------
+*/
+typedef union
+{
+   unsigned int xInt;
+   unsigned long lLong;
+   UINT64 llLong;
+   const void* pxPtr;
+   double dDouble;
+}
+ABCC_LogArgType;
+
+/*------------------------------------------------------------------------------
+** Binary log record, see ABCC_CFG_LOG_BINARY_ENABLED in abcc_config.h.
+**
+** llTimestamp     - Uptime in microseconds if ABCC_PORT_GetMonotonicTimeUs is
+**                   defined, otherwise in milliseconds.
+** pcFilename      - File name of the log call.
+** xLine           - Line number of the log call.
+** pcFormat        - Format string. Also serves as a unique identifier of the
+**                   log call that can be resolved from the linker map file.
+** auArgs          - Arguments, in the order they are consumed by pcFormat.
+** bNumArgs        - Number of valid entries in auArgs.
+** lAdditionalInfo - Additional info passed to the log macro.
+** eErrorCode      - Error code passed to the log macro.
+** bSeverity       - ABCC_LogSeverityType of the log call.
+**------------------------------------------------------------------------------
+*/
+typedef struct
+{
+#if ABCC_CFG_LOG_TIMESTAMPS_ENABLED
+   UINT64 llTimestamp;
+#endif
+#if ABCC_CFG_LOG_FILE_LINE_ENABLED
+   const char* pcFilename;
+   int xLine;
+#endif
+#if ABCC_CFG_LOG_STRINGS_ENABLED
+   const char* pcFormat;
+   ABCC_LogArgType auArgs[ ABCC_CFG_LOG_BINARY_MAX_ARGS ];
+   UINT8 bNumArgs;
+#endif
+   UINT32 lAdditionalInfo;
+   ABCC_ErrorCodeType eErrorCode;
+   UINT8 bSeverity;
+}
+ABCC_LogRecordType;
+
+/*------------------------------------------------------------------------------
+** Fetches the oldest record from the binary log ring buffer. Must only be
+** called from one context at a time. Records are not returned until they have
+** been completely written, a record being logged by an interrupted context
+** holds back newer records until it is done.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psRecord - Where to store the record.
+**
+** Returns:
+**    TRUE if a record was fetched, FALSE if the ring buffer is empty.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_LogReadRecord( ABCC_LogRecordType* psRecord );
+
+/*------------------------------------------------------------------------------
+** Prints a binary log record in the same format as the direct log output.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psRecord - Record to print.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_LogPrintRecord( const ABCC_LogRecordType* psRecord );
+
+/*------------------------------------------------------------------------------
+** Prints records from the binary log ring buffer using ABCC_PORT_printf().
+** Intended to be called from a low priority task or the main loop. The same
+** restrictions as for ABCC_LogReadRecord() apply.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iMaxRecords - Maximum number of records to print, 0 for no limit.
+**
+** Returns:
+**    Number of printed records.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_LogFlush( UINT16 iMaxRecords );
+
+/*------------------------------------------------------------------------------
+** Returns the total number of records dropped because the binary log ring
+** buffer was full.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT32 ABCC_LogGetNumDropped( void );
+#endif
+
 #endif
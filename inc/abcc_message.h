@@ -55,6 +55,90 @@ typedef void (*ABCC_SegMsgHandlerDoneFuncType)( void* pxObject );
 */
 typedef UINT8* (*ABCC_SegMsgHandlerNextBlockFuncType)( void* pxObject, UINT32* plSize );
 
+/*------------------------------------------------------------------------------
+** Size returned by an ABCC_SegMsgHandlerNextBlockFuncType callback together
+** with a NULL block to indicate that the block is being fetched and will be
+** supplied later by ABCC_SegmentationBlockReady(). Only allowed for sessions
+** started with ABCC_StartServerRespSegmentationSessionIoVec().
+**------------------------------------------------------------------------------
+*/
+#define ABCC_SEG_BLOCK_PENDING 0xFFFFFFFFUL
+
+/*------------------------------------------------------------------------------
+** Source region of a segmentation session, see
+** ABCC_StartServerRespSegmentationSessionIoVec().
+**------------------------------------------------------------------------------
+**   pxData - Pointer to the region.
+**   lSize  - Size of the region in octets.
+**------------------------------------------------------------------------------
+*/
+typedef struct ABCC_SegIoVecType
+{
+   const void* pxData;
+   UINT32 lSize;
+}
+ABCC_SegIoVecType;
+
+/*------------------------------------------------------------------------------
+** Function to indicate that a client segmentation session has finished.
+** See description of ABCC_StartClientCmdSegmentationSession().
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxObject  - User defined (Supplied in
+**                   ABCC_StartClientCmdSegmentationSession())
+**       psRespMsg - Response to the last segment if the session completed, or
+**                   the error response that ended the session. NULL if the
+**                   session was ended because a segment could not be sent.
+**                   The buffer is only valid during the call.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+typedef void (*ABCC_SegClientMsgHandlerDoneFuncType)( void* pxObject, ABP_MsgType* psRespMsg );
+
+/*------------------------------------------------------------------------------
+** Function to receive the data of a segmented command as the segments arrive.
+** See description of ABCC_StartServerCmdReassemblySession().
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxObject - User defined (Supplied in
+**                  ABCC_StartServerCmdReassemblySession())
+**       pxData   - Pointer to the segment data. Only valid during the call.
+**       iSize    - Number of octets in the segment.
+**       lOffset  - Octet offset of the segment data in the complete command.
+**
+** Returns:
+**       ABP_ERR_NO_ERROR to continue the reception. Any other value ends the
+**       session and is sent as error code in the response to the segment.
+**------------------------------------------------------------------------------
+*/
+typedef ABP_MsgErrorCodeType (*ABCC_SegMsgHandlerSinkFuncType)( void* pxObject,
+                                                                const void* pxData,
+                                                                UINT16 iSize,
+                                                                UINT32 lOffset );
+
+/*------------------------------------------------------------------------------
+** Function to indicate that a segmented command has been received.
+** See description of ABCC_StartServerCmdReassemblySession().
+**------------------------------------------------------------------------------
+** Arguments:
+**       pxObject   - User defined (Supplied in
+**                    ABCC_StartServerCmdReassemblySession())
+**       psMsg      - The last segment of the command. The user shall respond
+**                    to it as to any other command. NULL if the session was
+**                    aborted by the sender or ended by an error, the driver
+**                    has then already responded.
+**       lTotalSize - Total number of octets received.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+typedef void (*ABCC_SegReassemblyDoneFuncType)( void* pxObject,
+                                                ABP_MsgType* psMsg,
+                                                UINT32 lTotalSize );
+
 /*------------------------------------------------------------------------------
 ** Macros for basic endian swap. Used by conversion macros below.
 **------------------------------------------------------------------------------
@@ -95,6 +95,11 @@
 **
 ** 3. If none of the above is true no implementation is required.
 **
+** If ABCC_CFG_LOG_TIMESTAMPS_ENABLED, ABCC_CFG_LOG_BINARY_ENABLED or
+** ABCC_CFG_TRACE_ENABLED is 1, critical sections are also entered from within
+** the driver's own critical sections. The implementation must then support
+** nesting, i.e. restore the previous state when leaving as described in 1.
+**
 ** If the application is calling ABCC_RunTimerSystem() from a timer interrupt,
 ** the last three timer-specific macros will be defined. If left undefined by
 ** the application in abcc_software_port.h, these will assume the same
@@ -226,6 +231,50 @@
 #define ABCC_PORT_TIMER_ExitCritical() ABCC_PORT_ExitCritical()
 #endif
 
+/*------------------------------------------------------------------------------
+** Prevents the compiler, and the CPU if needed, from reordering memory accesses
+** across this point. Used by the binary log and the trace recorder to publish
+** a record filled in outside a critical section, and by their readers.
+**
+** A compiler barrier is provided for GCC compatible compilers. It is
+** sufficient on single core targets. For other compilers, or if records are
+** written and read on different cores, it must be ported.
+**------------------------------------------------------------------------------
+*/
+#ifndef ABCC_PORT_MemoryBarrier
+#if defined( __GNUC__ )
+#define ABCC_PORT_MemoryBarrier() __asm__ __volatile__( "" ::: "memory" )
+#else
+#define ABCC_PORT_MemoryBarrier()
+#endif
+#endif
+
+/*------------------------------------------------------------------------------
+** Optional monotonic time source with microsecond resolution.
+**
+** Define ABCC_PORT_GetMonotonicTimeUs in abcc_software_port.h if the platform
+** has a free running hardware counter or an OS clock that can be read as a
+** monotonic microsecond value. When defined, the driver uses it for the uptime,
+** the timer system, log timestamps and round trip time measurements. The time
+** passed to ABCC_RunTimerSystem() is then ignored and the elapsed time is
+** instead measured with this clock, so jitter in the call interval does not
+** accumulate.
+**
+** When not defined, all driver time is derived from the delta time passed to
+** ABCC_RunTimerSystem() and has millisecond resolution.
+**
+** The macro may be called both from the application context and from the
+** context calling ABCC_RunTimerSystem(), and must be reentrant.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    UINT64 time in microseconds. The start value is arbitrary, but the value
+**    must never decrease.
+**------------------------------------------------------------------------------
+*/
+
 /*------------------------------------------------------------------------------
 ** Copy a number of octets, from the source pointer to the destination pointer.
 **
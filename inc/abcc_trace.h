@@ -0,0 +1,157 @@
+/*******************************************************************************
+** Copyright 2024-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Message and frame trace recorder. See ABCC_CFG_TRACE_ENABLED in
+** abcc_config.h.
+**
+** The recorder keeps the most recent traced events in a fixed size ring buffer
+** that can be exported with ABCC_TraceDump() at any time, for example after an
+** error has been reported.
+**
+** Capture format
+** --------------
+** ABCC_TraceDump() writes a pcap capture (little endian, microsecond
+** timestamps, link type ABCC_TRACE_PCAP_LINKTYPE) that can be decoded with
+** tools/abcc_trace_decode.py or opened in any pcap capable tool:
+**
+**    Global header, 24 octets:
+**       UINT32 0xA1B2C3D4 (magic)
+**       UINT16 2, UINT16 4 (version)
+**       UINT32 0 (timezone), UINT32 0 (accuracy)
+**       UINT32 snap length, ABCC_CFG_TRACE_CAPTURE_SIZE + 4
+**       UINT32 ABCC_TRACE_PCAP_LINKTYPE
+**
+**    For each record, 16 octets:
+**       UINT32 timestamp seconds
+**       UINT32 timestamp microseconds
+**       UINT32 number of octets included in the file
+**       UINT32 original length, number of octets in the traced object + 4
+**
+**    followed by the record data:
+**       UINT8  record type, ABCC_TRACE_TYPE_*
+**       UINT8  event, ABCC_TRACE_EVENT_* for ABCC_TRACE_TYPE_MSG_EVENT
+**       UINT16 reserved, 0
+**       The first octets of the traced object. For messages the message
+**       header followed by message data, for frames the raw frame.
+**
+** The timestamps are the driver uptime, see ABCC_GetUptimeUs().
+********************************************************************************
+*/
+#ifndef ABCC_TRACE_H_
+#define ABCC_TRACE_H_
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+
+/*------------------------------------------------------------------------------
+** Link type used in the capture. This is the first of the link types reserved
+** by pcap for private use (LINKTYPE_USER0).
+**------------------------------------------------------------------------------
+*/
+#define ABCC_TRACE_PCAP_LINKTYPE 147
+
+/*------------------------------------------------------------------------------
+** Record types. Bit 0 gives the direction, 0 towards the ABCC and 1 from the
+** ABCC, and is not used for ABCC_TRACE_TYPE_MSG_EVENT.
+**------------------------------------------------------------------------------
+*/
+#define ABCC_TRACE_TYPE_MSG_TX      0x00
+#define ABCC_TRACE_TYPE_MSG_RX      0x01
+#define ABCC_TRACE_TYPE_MSG_EVENT   0x02
+#define ABCC_TRACE_TYPE_SPI_MOSI    0x10
+#define ABCC_TRACE_TYPE_SPI_MISO    0x11
+#define ABCC_TRACE_TYPE_UART_TX     0x20
+#define ABCC_TRACE_TYPE_UART_RX     0x21
+
+/*------------------------------------------------------------------------------
+** Message events traced with ABCC_TRACE_TYPE_MSG_EVENT.
+**------------------------------------------------------------------------------
+*/
+#define ABCC_TRACE_EVENT_NONE             0x00
+#define ABCC_TRACE_EVENT_CMD_QUEUED       0x01
+#define ABCC_TRACE_EVENT_CMD_QUEUE_FULL   0x02
+#define ABCC_TRACE_EVENT_CMD_DEQUEUED     0x03
+#define ABCC_TRACE_EVENT_RESP_QUEUED      0x04
+#define ABCC_TRACE_EVENT_RESP_QUEUE_FULL  0x05
+#define ABCC_TRACE_EVENT_RESP_DEQUEUED    0x06
+#define ABCC_TRACE_EVENT_RESP_ROUTED      0x07
+#define ABCC_TRACE_EVENT_RESP_NO_HANDLER  0x08
+
+#if ABCC_CFG_TRACE_ENABLED
+/*------------------------------------------------------------------------------
+** Function called by ABCC_TraceDump() for each part of the capture.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pxData         - Capture data. Octets are packed in the same way as in
+**                     message buffers.
+**    iSizeInOctets  - Number of octets in pxData.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+typedef void (*ABCC_TraceWriteFuncType)( const void* pxData, UINT16 iSizeInOctets );
+
+/*------------------------------------------------------------------------------
+** Exports the trace ring buffer, oldest record first, in the capture format
+** described at the top of this file. Tracing continues while the dump is in
+** progress. Records overwritten or being written during the dump are skipped.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pnWrite - Function receiving the capture data.
+**
+** Returns:
+**    Number of records written.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT16 ABCC_TraceDump( ABCC_TraceWriteFuncType pnWrite );
+
+/*------------------------------------------------------------------------------
+** Discards all records in the trace ring buffer.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_TraceClear( void );
+
+/*------------------------------------------------------------------------------
+** The functions/macros below are intended for internal use only. They are
+** called by the driver at the points where the corresponding debug printouts
+** are made.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_TraceMsg( UINT8 bType, UINT8 bEvent, const ABP_MsgType* psMsg );
+EXTFUNC void ABCC_TraceFrame( UINT8 bType, const void* pxData, UINT16 iSizeInOctets );
+
+#define ABCC_TRACE_MSG_TX( psMsg ) \
+   ABCC_TraceMsg( ABCC_TRACE_TYPE_MSG_TX, ABCC_TRACE_EVENT_NONE, psMsg )
+#define ABCC_TRACE_MSG_RX( psMsg ) \
+   ABCC_TraceMsg( ABCC_TRACE_TYPE_MSG_RX, ABCC_TRACE_EVENT_NONE, psMsg )
+#define ABCC_TRACE_MSG_EVENT( psMsg, bEvent ) \
+   ABCC_TraceMsg( ABCC_TRACE_TYPE_MSG_EVENT, bEvent, psMsg )
+#define ABCC_TRACE_SPI_MOSI( piData, iSizeInWords ) \
+   ABCC_TraceFrame( ABCC_TRACE_TYPE_SPI_MOSI, piData, (UINT16)( ( iSizeInWords ) * 2 ) )
+#define ABCC_TRACE_SPI_MISO( piData, iSizeInWords ) \
+   ABCC_TraceFrame( ABCC_TRACE_TYPE_SPI_MISO, piData, (UINT16)( ( iSizeInWords ) * 2 ) )
+#define ABCC_TRACE_UART_TX( pbData, iSizeInOctets ) \
+   ABCC_TraceFrame( ABCC_TRACE_TYPE_UART_TX, pbData, iSizeInOctets )
+#define ABCC_TRACE_UART_RX( pbData, iSizeInOctets ) \
+   ABCC_TraceFrame( ABCC_TRACE_TYPE_UART_RX, pbData, iSizeInOctets )
+#else
+#define ABCC_TRACE_MSG_TX( psMsg )
+#define ABCC_TRACE_MSG_RX( psMsg )
+#define ABCC_TRACE_MSG_EVENT( psMsg, bEvent )
+#define ABCC_TRACE_SPI_MOSI( piData, iSizeInWords )
+#define ABCC_TRACE_SPI_MISO( piData, iSizeInWords )
+#define ABCC_TRACE_UART_TX( pbData, iSizeInOctets )
+#define ABCC_TRACE_UART_RX( pbData, iSizeInOctets )
+#endif
+
+#endif  /* inclusion lock */
@@ -7,6 +7,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_CMD_SEQ
+
 #include "abcc_types.h"
 #include "abp.h"
 #include "abcc.h"
@@ -15,6 +17,7 @@
 #include "abcc_log.h"
 #include "abcc_link.h"
 #include "abcc_memory.h"
+#include "abcc_timer.h"
 
 #if ABCC_CFG_DRV_CMD_SEQ_ENABLED
 
@@ -22,6 +25,21 @@
 #error "ABCC_CFG_MAX_NUM_CMD_SEQ larger than 255 not supported"
 #endif
 
+/*
+** Marks a source id that is not mapped to a command sequence.
+*/
+#define CMD_SEQ_NO_ENTRY   ( 0xFF )
+
+/*
+** Marks that no step is selected.
+*/
+#define CMD_SEQ_NO_STEP    ( 0xFF )
+
+/*
+** The step timeout is doubled for each retry, up to this many times.
+*/
+#define CMD_SEQ_MAX_BACKOFF_SHIFT   ( 15 )
+
 /*******************************************************************************
 ** Typedefs
 ********************************************************************************
@@ -36,13 +54,40 @@ typedef enum CmdSeqState
 }
 CmdSeqStateType;
 
+/*
+** A sequence step that has been sent and waits for its response, or that
+** shall be sent again (fReissue). psDeferredResp holds a response received
+** while the sequence was busy in another context. lDeadlineMs is the uptime
+** when the response times out and bNumTimeouts the number of timeouts so far.
+*/
+typedef struct CmdSeqStep
+{
+   ABP_MsgType*            psDeferredResp;
+   UINT8                   bSeqIndex;
+   UINT8                   bSourceId;
+   BOOL                    fReissue;
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+   UINT32                  lDeadlineMs;
+   UINT8                   bNumTimeouts;
+#endif
+}
+CmdSeqStepType;
+
+/*
+** psNext and psPrev link the entry into the ready queue while it is in
+** CMD_SEQ_STATE_RETRIGGER. A free entry is linked into the free list with
+** psNext.
+*/
 typedef struct CmdSeqHandler
 {
+   struct CmdSeqHandler*   psNext;
+   struct CmdSeqHandler*   psPrev;
    const ABCC_CmdSeqType*  pasCmdSeq;
    ABCC_CmdSeqDoneHandler  pnSeqDone;
    CmdSeqStateType         eState;
    UINT8                   bCurrSeqIndex;
-   UINT8                   bSourceId;
+   UINT8                   bNumSteps;
+   CmdSeqStepType          asSteps[ ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT ];
    UINT8                   bRetryCount;
    void*                   pxUserData;
    ABCC_CmdSeqResultType   eSeqResult;
@@ -56,11 +101,38 @@ CmdSeqEntryType;
 static UINT16 abcc_iNeedReTriggerCount;
 static CmdSeqEntryType abcc_asCmdSeq[ ABCC_CFG_MAX_NUM_CMD_SEQ ];
 
+/*
+** Queue of entries in CMD_SEQ_STATE_RETRIGGER (abcc_iNeedReTriggerCount
+** entries) and list of unallocated entries.
+*/
+static CmdSeqEntryType* abcc_psReadyHead;
+static CmdSeqEntryType* abcc_psReadyTail;
+static CmdSeqEntryType* abcc_psFreeHead;
+
+/*
+** Index in abcc_asCmdSeq of the entry waiting for a response with a given
+** source id. CMD_SEQ_NO_ENTRY if none.
+*/
+static UINT8 abcc_abSourceIdToEntry[ 256 ];
+
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+/*
+** Timer used for all step timeouts. It is started for the earliest deadline
+** (abcc_lStepTmoDeadlineMs) of the outstanding steps. The expired steps are
+** handled in ABCC_CmdSequencerExec().
+*/
+static ABCC_TimerHandle abcc_xStepTmoHandle;
+static BOOL abcc_fStepTmoStarted;
+static UINT32 abcc_lStepTmoDeadlineMs;
+static volatile BOOL abcc_fStepTmoExpired;
+#endif
+
 /*******************************************************************************
 ** Forward declarations
 ********************************************************************************
 */
-static BOOL ExecCmdSequence( CmdSeqEntryType* psCmdSeqHandler, ABP_MsgType* psMsg );
+static void ExecCmdSequence( CmdSeqEntryType* psEntry, ABP_MsgType* psMsg );
+static void RunCmdSequence( CmdSeqEntryType* psEntry, ABP_MsgType* psMsg );
 static void HandleResponse( ABP_MsgType* psMsg );
 static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq );
 static BOOL CheckAndSetState( CmdSeqEntryType* psCmdSeqHandler,
@@ -84,7 +156,6 @@ static BOOL CheckAndSetState( CmdSeqEntryType* psCmdSeqHandler,
 */
 static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq )
 {
-   UINT8 i;
    CmdSeqEntryType* psEntry;
    ABCC_PORT_UseCritical();
 
@@ -92,14 +163,12 @@ static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq )
 
    ABCC_PORT_EnterCritical();
 
-   for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
+   if( abcc_psFreeHead != NULL )
    {
-      if( abcc_asCmdSeq[ i ].pasCmdSeq == NULL )
-      {
-         psEntry = &abcc_asCmdSeq[ i ];
-         psEntry->pasCmdSeq = pasCmdSeq;
-         break;
-      }
+      psEntry = abcc_psFreeHead;
+      abcc_psFreeHead = psEntry->psNext;
+      psEntry->psNext = NULL;
+      psEntry->pasCmdSeq = pasCmdSeq;
    }
 
    ABCC_PORT_ExitCritical();
@@ -107,12 +176,14 @@ static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq )
 }
 
 /*------------------------------------------------------------------------------
-** Resets handler to initial state. If it's the initial reset after startup the
-** reset of state will have no side effect.
+** Resets handler to initial state and returns it to the free list. If it's the
+** initial reset after startup the reset of state will have no side effect.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    psEntry  - Pointer to entry.
-**    fInitial - Set to TRUE if it's the initial reset after startup.
+**    fInitial - Set to TRUE if it's the initial reset after startup or if the
+**               caller is already in a critical section and has removed the
+**               entry from the ready queue.
 **
 ** Returns:
 **    None
@@ -120,6 +191,8 @@ static CmdSeqEntryType* AllocCmdSeqEntry( const ABCC_CmdSeqType* pasCmdSeq )
 */
 static void ResetCmdSeqEntry( CmdSeqEntryType* psEntry, BOOL fInitial )
 {
+   ABCC_PORT_UseCritical();
+
    if( psEntry != NULL )
    {
       if( fInitial )
@@ -129,7 +202,7 @@ static void ResetCmdSeqEntry( CmdSeqEntryType* psEntry, BOOL fInitial )
       else
       {
          /*
-         ** This call may affect file global abcc_iNeedReTriggerCount
+         ** This call may affect the ready queue
          */
          if( !CheckAndSetState( psEntry, CMD_SEQ_STATE_ANY, CMD_SEQ_STATE_NOT_STARTED ) )
          {
@@ -140,39 +213,200 @@ static void ResetCmdSeqEntry( CmdSeqEntryType* psEntry, BOOL fInitial )
       psEntry->pasCmdSeq = NULL;
       psEntry->pnSeqDone = NULL;
       psEntry->bCurrSeqIndex = 0;
-      psEntry->bSourceId = 0;
+      psEntry->bNumSteps = 0;
       psEntry->bRetryCount = 0;
       psEntry->pxUserData = NULL;
       psEntry->eSeqResult = ABCC_CMDSEQ_RESULT_COMPLETED;
+      psEntry->psPrev = NULL;
+
+      if( fInitial )
+      {
+         psEntry->psNext = abcc_psFreeHead;
+         abcc_psFreeHead = psEntry;
+      }
+      else
+      {
+         ABCC_PORT_EnterCritical();
+         psEntry->psNext = abcc_psFreeHead;
+         abcc_psFreeHead = psEntry;
+         ABCC_PORT_ExitCritical();
+      }
    }
 }
 
 /*------------------------------------------------------------------------------
-** Find entry mapped to source id. Used when response message is mapped to
-** command sequence.
+** Find entry and step mapped to the source id of a response message. Used when
+** the response message is mapped to a command sequence.
+** If the entry is waiting for responses it is set to CMD_SEQ_STATE_BUSY and
+** returned. If the entry is busy in another context the response is stored in
+** the step and handled by that context before it leaves the busy state.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    bSourceId - Source id
+**    psMsg  - Pointer to response message
+**    pbStep - Index of the step the response belongs to
 **
 ** Returns:
-**    CmdSeqEntryType* - Mapped handler. NULL if not found.
+**    CmdSeqEntryType* - Mapped handler. NULL if not found or if the response
+**                       has been deferred.
 **------------------------------------------------------------------------------
 */
-static CmdSeqEntryType* FindCmdSeqEntryFromSourceId( UINT8 bSourceId )
+static CmdSeqEntryType* ClaimCmdSeqEntry( ABP_MsgType* psMsg, UINT8* pbStep )
 {
    UINT8 i;
+   UINT8 bSourceId;
+   CmdSeqEntryType* psEntry;
+   CmdSeqEntryType* psFound;
+   ABCC_PORT_UseCritical();
 
-   for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
+   bSourceId = ABCC_GetMsgSourceId( psMsg );
+   psFound = NULL;
+
+   ABCC_PORT_EnterCritical();
+
+   if( abcc_abSourceIdToEntry[ bSourceId ] != CMD_SEQ_NO_ENTRY )
+   {
+      psEntry = &abcc_asCmdSeq[ abcc_abSourceIdToEntry[ bSourceId ] ];
+
+      if( ( ( psEntry->eState == CMD_SEQ_STATE_WAIT_RESP ) ||
+            ( psEntry->eState == CMD_SEQ_STATE_BUSY ) ) &&
+          ( psEntry->pasCmdSeq != NULL ) )
+      {
+         for( i = 0; i < psEntry->bNumSteps; i++ )
+         {
+            if( !psEntry->asSteps[ i ].fReissue &&
+                ( psEntry->asSteps[ i ].psDeferredResp == NULL ) &&
+                ( psEntry->asSteps[ i ].bSourceId == bSourceId ) )
+            {
+               psFound = psEntry;
+               *pbStep = i;
+               break;
+            }
+         }
+      }
+   }
+
+   psEntry = psFound;
+
+   if( psEntry != NULL )
+   {
+      abcc_abSourceIdToEntry[ bSourceId ] = CMD_SEQ_NO_ENTRY;
+
+      if( psEntry->eState == CMD_SEQ_STATE_WAIT_RESP )
+      {
+         /*
+         ** Leaving CMD_SEQ_STATE_WAIT_RESP has no side effects, see
+         ** CheckAndSetState().
+         */
+         psEntry->eState = CMD_SEQ_STATE_BUSY;
+      }
+      else
+      {
+         psEntry->asSteps[ *pbStep ].psDeferredResp = psMsg;
+         ABCC_MemSetBufferStatus( psMsg, ABCC_MEM_BUFSTAT_OWNED );
+         psEntry = NULL;
+      }
+   }
+
+   ABCC_PORT_ExitCritical();
+
+   return( psEntry );
+}
+
+/*------------------------------------------------------------------------------
+** Take a response that was received while the entry was busy. If there is none
+** the entry is set to CMD_SEQ_STATE_WAIT_RESP.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to entry in CMD_SEQ_STATE_BUSY state.
+**    pbStep  - Index of the step the response belongs to
+**
+** Returns:
+**    ABP_MsgType* - Deferred response. NULL if there is none.
+**------------------------------------------------------------------------------
+*/
+static ABP_MsgType* TakeDeferredResponse( CmdSeqEntryType* psEntry, UINT8* pbStep )
+{
+   UINT8 i;
+   ABP_MsgType* psMsg;
+   ABCC_PORT_UseCritical();
+
+   psMsg = NULL;
+
+   ABCC_PORT_EnterCritical();
+
+   for( i = 0; i < psEntry->bNumSteps; i++ )
+   {
+      if( psEntry->asSteps[ i ].psDeferredResp != NULL )
+      {
+         psMsg = psEntry->asSteps[ i ].psDeferredResp;
+         psEntry->asSteps[ i ].psDeferredResp = NULL;
+         *pbStep = i;
+         break;
+      }
+   }
+
+   if( psMsg == NULL )
+   {
+      psEntry->eState = CMD_SEQ_STATE_WAIT_RESP;
+   }
+
+   ABCC_PORT_ExitCritical();
+
+   if( psMsg != NULL )
+   {
+      ABCC_MemSetBufferStatus( psMsg, ABCC_MEM_BUFSTAT_IN_APPL_HANDLER );
+   }
+
+   return( psMsg );
+}
+
+/*------------------------------------------------------------------------------
+** Count the steps that have been sent and wait for a response.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to entry.
+**
+** Returns:
+**    Number of outstanding commands.
+**------------------------------------------------------------------------------
+*/
+static UINT8 NumWaitingSteps( const CmdSeqEntryType* psEntry )
+{
+   UINT8 i;
+   UINT8 bNumWaiting;
+
+   bNumWaiting = 0;
+
+   for( i = 0; i < psEntry->bNumSteps; i++ )
    {
-      if( ( abcc_asCmdSeq[ i ].eState == CMD_SEQ_STATE_WAIT_RESP ) &&
-          ( abcc_asCmdSeq[ i ].pasCmdSeq != NULL ) &&
-            abcc_asCmdSeq[ i ].bSourceId == bSourceId )
+      if( !psEntry->asSteps[ i ].fReissue )
       {
-         return( &abcc_asCmdSeq[ i ] );
+         bNumWaiting++;
       }
    }
 
-   return( NULL );
+   return( bNumWaiting );
+}
+
+/*------------------------------------------------------------------------------
+** Remove a step when it is completed. The last step is moved into its place.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to entry.
+**    bStep   - Index of the step.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void RemoveStep( CmdSeqEntryType* psEntry, UINT8 bStep )
+{
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   psEntry->bNumSteps--;
+   psEntry->asSteps[ bStep ] = psEntry->asSteps[ psEntry->bNumSteps ];
+   ABCC_PORT_ExitCritical();
 }
 
 /*------------------------------------------------------------------------------
@@ -188,24 +422,85 @@ static CmdSeqEntryType* FindCmdSeqEntryFromSourceId( UINT8 bSourceId )
 */
 static BOOL ValidateHandle( const ABCC_CmdSeqHandle xHandle )
 {
-   UINT8 i;
+   const CmdSeqEntryType* psEntry;
+   const UINT8* pbHandle;
+   const UINT8* pbFirst;
 
-   for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
+   psEntry = (const CmdSeqEntryType*)xHandle;
+   pbHandle = (const UINT8*)xHandle;
+   pbFirst = (const UINT8*)abcc_asCmdSeq;
+
+   if( ( pbHandle < pbFirst ) ||
+       ( pbHandle >= (const UINT8*)&abcc_asCmdSeq[ ABCC_CFG_MAX_NUM_CMD_SEQ ] ) ||
+       ( ( (UINT32)( pbHandle - pbFirst ) % sizeof( CmdSeqEntryType ) ) != 0 ) )
    {
-      if( xHandle == &abcc_asCmdSeq[ i ] )
-      {
-         if( abcc_asCmdSeq[ i ].pasCmdSeq != NULL )
-         {
-            return( TRUE );
-         }
-         else
-         {
-            break;
-         }
-      }
+      return( FALSE );
+   }
+
+   return( psEntry->pasCmdSeq != NULL );
+}
+
+/*------------------------------------------------------------------------------
+** Links entry last in the ready queue. Must be called in a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to entry
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void LinkReady( CmdSeqEntryType* psEntry )
+{
+   psEntry->psNext = NULL;
+   psEntry->psPrev = abcc_psReadyTail;
+
+   if( abcc_psReadyTail != NULL )
+   {
+      abcc_psReadyTail->psNext = psEntry;
+   }
+   else
+   {
+      abcc_psReadyHead = psEntry;
    }
 
-   return( FALSE );
+   abcc_psReadyTail = psEntry;
+   abcc_iNeedReTriggerCount++;
+}
+
+/*------------------------------------------------------------------------------
+** Removes entry from the ready queue. Must be called in a critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to entry
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void UnlinkReady( CmdSeqEntryType* psEntry )
+{
+   if( psEntry->psPrev != NULL )
+   {
+      psEntry->psPrev->psNext = psEntry->psNext;
+   }
+   else
+   {
+      abcc_psReadyHead = psEntry->psNext;
+   }
+
+   if( psEntry->psNext != NULL )
+   {
+      psEntry->psNext->psPrev = psEntry->psPrev;
+   }
+   else
+   {
+      abcc_psReadyTail = psEntry->psPrev;
+   }
+
+   psEntry->psNext = NULL;
+   psEntry->psPrev = NULL;
+   abcc_iNeedReTriggerCount--;
 }
 
 /*------------------------------------------------------------------------------
@@ -239,13 +534,13 @@ static BOOL CheckAndSetState( CmdSeqEntryType* psCmdSeqHandler,
       if( ( psCmdSeqHandler->eState == CMD_SEQ_STATE_RETRIGGER ) &&
             eNewState != CMD_SEQ_STATE_RETRIGGER )
       {
-         abcc_iNeedReTriggerCount--;
+         UnlinkReady( psCmdSeqHandler );
       }
 
       if( ( psCmdSeqHandler->eState != CMD_SEQ_STATE_RETRIGGER ) &&
             eNewState == CMD_SEQ_STATE_RETRIGGER )
       {
-         abcc_iNeedReTriggerCount++;
+         LinkReady( psCmdSeqHandler );
       }
 
       psCmdSeqHandler->eState = eNewState;
@@ -269,13 +564,14 @@ static BOOL CheckAndSetState( CmdSeqEntryType* psCmdSeqHandler,
 */
 static void DoAbort( CmdSeqEntryType* psEntry )
 {
-   BOOL fFreeSourceId;
-   UINT8 bSourceId = 0;
+   UINT8 i;
+   UINT8 bNumSourceIds;
+   UINT8 abSourceId[ ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT ];
    ABCC_CmdSeqDoneHandler pnSeqDone;
    void *pxUserData;
    ABCC_PORT_UseCritical();
 
-   fFreeSourceId = FALSE;
+   bNumSourceIds = 0;
    ABCC_PORT_EnterCritical();
 
    if( psEntry->eState == CMD_SEQ_STATE_BUSY )
@@ -290,12 +586,16 @@ static void DoAbort( CmdSeqEntryType* psEntry )
    {
       if( psEntry->eState == CMD_SEQ_STATE_RETRIGGER )
       {
-         abcc_iNeedReTriggerCount--;
+         UnlinkReady( psEntry );
       }
-      if( psEntry->eState == CMD_SEQ_STATE_WAIT_RESP )
+
+      for( i = 0; i < psEntry->bNumSteps; i++ )
       {
-         bSourceId = psEntry->bSourceId;
-         fFreeSourceId = TRUE;
+         if( !psEntry->asSteps[ i ].fReissue )
+         {
+            abSourceId[ bNumSourceIds++ ] = psEntry->asSteps[ i ].bSourceId;
+            abcc_abSourceIdToEntry[ psEntry->asSteps[ i ].bSourceId ] = CMD_SEQ_NO_ENTRY;
+         }
       }
 
       ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Aborted\n",
@@ -320,209 +620,505 @@ static void DoAbort( CmdSeqEntryType* psEntry )
    ** Free of sourceId is done outside critical section to avoid nested
    ** critical sections. Result can be ignored
    */
-   if( fFreeSourceId )
+   for( i = 0; i < bNumSourceIds; i++ )
    {
-      (void)ABCC_LinkGetMsgHandler( bSourceId );
+      (void)ABCC_LinkGetMsgHandler( abSourceId[ i ] );
    }
 }
 
 /*------------------------------------------------------------------------------
-** Common response handler for all response messages routed to the command
-** sequencer. Implements ABCC_MsgHandlerFuncType function callback (abcc.h)
+** Internal abort of the sequence. No more steps are executed, responses to
+** outstanding commands are received but not passed to the application.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    psMsg - Pointer to response message.
+**    psEntry - Pointer to handler
 **
 ** Returns:
 **    None
 **------------------------------------------------------------------------------
 */
-static void HandleResponse( ABP_MsgType* psMsg )
+static void AbortCmdSequence( CmdSeqEntryType* psEntry )
 {
-   UINT8 bSourceId;
-   CmdSeqEntryType* psEntry;
-   ABCC_CmdSeqRespStatusType eStatus;
+   UINT8 i;
 
+   ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Aborted\n",
+         (void*)psEntry->pasCmdSeq );
 
-   bSourceId = ABCC_GetMsgSourceId( psMsg );
-   psEntry = FindCmdSeqEntryFromSourceId( bSourceId );
+   /*
+   ** Move to end of sequence.
+   */
+   while( psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ].pnCmdHandler != NULL )
+   {
+      psEntry->bCurrSeqIndex++;
+   }
 
-   if( psEntry != NULL )
+   i = 0;
+   while( i < psEntry->bNumSteps )
    {
-      /*
-      ** The corresponding command sequence found
-      */
-      if( CheckAndSetState( psEntry, CMD_SEQ_STATE_WAIT_RESP, CMD_SEQ_STATE_BUSY ) )
+      if( psEntry->asSteps[ i ].fReissue )
       {
-         if( psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ].pnRespHandler != NULL )
-         {
-            /*
-            ** Pass the response message to the application.
-            */
-            ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->%s()\n",
-               (void*)psEntry->pasCmdSeq,
-               psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ].pcRespName );
-
-            eStatus = psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ].pnRespHandler( psMsg, psEntry->pxUserData );
-
-            if( eStatus == ABCC_CMDSEQ_RESP_EXEC_NEXT )
-            {
-               /*
-               ** Move to next command in sequence
-               */
-               psEntry->bCurrSeqIndex++;
-            }
-            else if( eStatus == ABCC_CMDSEQ_RESP_ABORT )
-            {
-               ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Aborted\n",
-                     (void*)psEntry->pasCmdSeq );
-               /*
-               ** Loop until end of sequence.
-               */
-               while( psEntry->pasCmdSeq[ ++psEntry->bCurrSeqIndex ].pnCmdHandler != NULL );
-
-               psEntry->eSeqResult = ABCC_CMDSEQ_RESULT_ABORT_INT;
-            }
-            else if( eStatus == ABCC_CMDSEQ_RESP_EXEC_CURRENT )
-            {
-               ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Executing same sequence step again\n",
-                     (void*)psEntry->pasCmdSeq );
-            }
-            else
-            {
-               ABCC_LOG_ERROR( ABCC_EC_PARAMETER_NOT_VALID,
-                  (UINT32)eStatus,
-                  "Bad return parameter from response handler (%d)\n",
-                  eStatus );
-               return;
-            }
-         }
-         else
-         {
-            ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->No response handler\n",
-                  (void*)psEntry->pasCmdSeq );
-
-            psEntry->bCurrSeqIndex++;
-         }
-
-         if( ABCC_MemGetBufferStatus( psMsg ) != ABCC_MEM_BUFSTAT_IN_APPL_HANDLER )
-         {
-            /*
-            ** The application has used the buffer for other things.
-            */
-            psMsg = ABCC_GetCmdMsgBuffer();
-         }
-
-         /*
-         ** Execute next command. The return value is ignored
-         ** since the message deallocation will be handled after return of this
-         ** function
-         */
-         (void)ExecCmdSequence( psEntry, psMsg );
+         RemoveStep( psEntry, i );
+      }
+      else
+      {
+         i++;
       }
    }
+
+   psEntry->eSeqResult = ABCC_CMDSEQ_RESULT_ABORT_INT;
 }
 
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
 /*------------------------------------------------------------------------------
-** Execute the command sequence
+** Timeout callback of the step timer. Called from the timer tick context, the
+** expired steps are handled in ABCC_CmdSequencerExec().
 **------------------------------------------------------------------------------
 ** Arguments:
-**    psEntry - Pointer to handler
-**    psMsg   - Pointer to allocated command message buffer.
+**    None
 **
 ** Returns:
-**    TRUE    - Command buffer sent or freed.
-**    FALSE   - Command buffer not sent or freed.
+**    None
 **------------------------------------------------------------------------------
 */
-static BOOL ExecCmdSequence( CmdSeqEntryType* psEntry, ABP_MsgType* psMsg )
+static void StepTimerTimeout( void )
 {
-   BOOL fCmdBufferConsumed;
-   const ABCC_CmdSeqType* psCmdSeq;
-   ABCC_CmdSeqCmdStatusType eStatus;
-
-   fCmdBufferConsumed = FALSE;
+   abcc_fStepTmoStarted = FALSE;
+   abcc_fStepTmoExpired = TRUE;
+}
 
-   if( psMsg != NULL )
+/*------------------------------------------------------------------------------
+** Get the response timeout of a step. The configured timeout is doubled for
+** each timeout that has already occurred.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psCmdSeq     - Pointer to the sequence step definition.
+**    bNumTimeouts - Number of timeouts so far.
+**
+** Returns:
+**    Timeout in ms.
+**------------------------------------------------------------------------------
+*/
+static UINT32 StepTimeoutMs( const ABCC_CmdSeqType* psCmdSeq, UINT8 bNumTimeouts )
+{
+   if( bNumTimeouts > CMD_SEQ_MAX_BACKOFF_SHIFT )
    {
-      psEntry->bRetryCount = 0;
-      psCmdSeq = &psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ];
+      bNumTimeouts = CMD_SEQ_MAX_BACKOFF_SHIFT;
+   }
 
-      while( ( psCmdSeq->pnCmdHandler != NULL ) && !fCmdBufferConsumed )
-      {
-         ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->%s()\n",
-               (void*)psEntry->pasCmdSeq,
-               psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ].pcCmdName );
+   return( (UINT32)psCmdSeq->iTimeoutMs << bNumTimeouts );
+}
+
+/*------------------------------------------------------------------------------
+** Start the step timer if it is not running or if the deadline is earlier than
+** the one it is running for.
+**------------------------------------------------------------------------------
+** Arguments:
+**    lDeadlineMs - Uptime in ms when the timer shall expire.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void StartStepTimer( UINT32 lDeadlineMs )
+{
+   BOOL fStart;
+   UINT32 lNowMs;
+   ABCC_PORT_UseCritical();
+
+   fStart = FALSE;
+
+   ABCC_PORT_EnterCritical();
+   if( !abcc_fStepTmoStarted ||
+       ( (INT32)( lDeadlineMs - abcc_lStepTmoDeadlineMs ) < 0 ) )
+   {
+      abcc_fStepTmoStarted = TRUE;
+      abcc_lStepTmoDeadlineMs = lDeadlineMs;
+      fStart = TRUE;
+   }
+   ABCC_PORT_ExitCritical();
+
+   /*
+   ** The timer is started outside the critical section to avoid nested
+   ** critical sections.
+   */
+   if( fStart )
+   {
+      lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+
+      if( (INT32)( lDeadlineMs - lNowMs ) > 0 )
+      {
+         (void)ABCC_TimerStart( abcc_xStepTmoHandle, lDeadlineMs - lNowMs );
+      }
+      else
+      {
+         (void)ABCC_TimerStart( abcc_xStepTmoHandle, 0 );
+      }
+   }
+}
+#endif
+
+/*------------------------------------------------------------------------------
+** Pass a response message to the response handler of its sequence step.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to handler in CMD_SEQ_STATE_BUSY state.
+**    bStep   - Index of the step the response belongs to.
+**    psMsg   - Pointer to response message.
+**
+** Returns:
+**    ABP_MsgType* - The message buffer if it can be reused for the next
+**                   command. NULL if the application has used the buffer.
+**------------------------------------------------------------------------------
+*/
+static ABP_MsgType* HandleStepResponse( CmdSeqEntryType* psEntry,
+                                        UINT8 bStep,
+                                        ABP_MsgType* psMsg )
+{
+   const ABCC_CmdSeqType* psCmdSeq;
+   ABCC_CmdSeqRespStatusType eStatus;
+
+   psCmdSeq = &psEntry->pasCmdSeq[ psEntry->asSteps[ bStep ].bSeqIndex ];
 
-         eStatus = psCmdSeq->pnCmdHandler( psMsg, psEntry->pxUserData );
-         if( eStatus == ABCC_CMDSEQ_CMD_SKIP )
+   if( psEntry->eSeqResult != ABCC_CMDSEQ_RESULT_COMPLETED )
+   {
+      /*
+      ** The sequence is aborted, the response is only collected.
+      */
+      RemoveStep( psEntry, bStep );
+   }
+   else if( psCmdSeq->pnRespHandler != NULL )
+   {
+      /*
+      ** Pass the response message to the application.
+      */
+      ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->%s()\n",
+         (void*)psEntry->pasCmdSeq,
+         psCmdSeq->pcRespName );
+
+      eStatus = psCmdSeq->pnRespHandler( psMsg, psEntry->pxUserData );
+
+      if( eStatus == ABCC_CMDSEQ_RESP_EXEC_NEXT )
+      {
+         /*
+         ** Step completed
+         */
+         RemoveStep( psEntry, bStep );
+      }
+      else if( eStatus == ABCC_CMDSEQ_RESP_ABORT )
+      {
+         RemoveStep( psEntry, bStep );
+         AbortCmdSequence( psEntry );
+      }
+      else if( eStatus == ABCC_CMDSEQ_RESP_EXEC_CURRENT )
+      {
+         ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Executing same sequence step again\n",
+               (void*)psEntry->pasCmdSeq );
+
+         psEntry->asSteps[ bStep ].fReissue = TRUE;
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+         psEntry->asSteps[ bStep ].bNumTimeouts = 0;
+#endif
+      }
+      else
+      {
+         ABCC_LOG_ERROR( ABCC_EC_PARAMETER_NOT_VALID,
+            (UINT32)eStatus,
+            "Bad return parameter from response handler (%d)\n",
+            eStatus );
+
+         RemoveStep( psEntry, bStep );
+         AbortCmdSequence( psEntry );
+      }
+   }
+   else
+   {
+      ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->No response handler\n",
+            (void*)psEntry->pasCmdSeq );
+
+      RemoveStep( psEntry, bStep );
+   }
+
+   if( ABCC_MemGetBufferStatus( psMsg ) != ABCC_MEM_BUFSTAT_IN_APPL_HANDLER )
+   {
+      /*
+      ** The application has used the buffer for other things.
+      */
+      psMsg = NULL;
+   }
+
+   return( psMsg );
+}
+
+/*------------------------------------------------------------------------------
+** Common response handler for all response messages routed to the command
+** sequencer. Implements ABCC_MsgHandlerFuncType function callback (abcc.h)
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg - Pointer to response message.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void HandleResponse( ABP_MsgType* psMsg )
+{
+   UINT8 bStep;
+   CmdSeqEntryType* psEntry;
+
+   psEntry = ClaimCmdSeqEntry( psMsg, &bStep );
+
+   if( psEntry != NULL )
+   {
+      /*
+      ** The corresponding command sequence found. The message buffer is
+      ** either reused for the next command or freed, the deallocation is
+      ** otherwise handled after return of this function.
+      */
+      psMsg = HandleStepResponse( psEntry, bStep, psMsg );
+      RunCmdSequence( psEntry, psMsg );
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Execute the command sequence. Steps are sent until a step must wait for
+** outstanding responses, the in-flight window is full or no command buffer is
+** available.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to handler in CMD_SEQ_STATE_BUSY state.
+**    psMsg   - Pointer to allocated command message buffer or NULL. The buffer
+**              is always sent or freed.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void ExecCmdSequence( CmdSeqEntryType* psEntry, ABP_MsgType* psMsg )
+{
+   UINT8 i;
+   UINT8 bSeqIndex;
+   CmdSeqStepType* psStep;
+   const ABCC_CmdSeqType* psCmdSeq;
+   ABCC_CmdSeqCmdStatusType eStatus;
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+   UINT32 lDeadlineMs;
+#endif
+   ABCC_PORT_UseCritical();
+
+   while( TRUE )
+   {
+      /*
+      ** Steps to execute again go first.
+      */
+      psStep = NULL;
+      for( i = 0; i < psEntry->bNumSteps; i++ )
+      {
+         if( psEntry->asSteps[ i ].fReissue )
          {
-            ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Command not sent, jump to next sequence step\n",
-                  (void*)psEntry->pasCmdSeq );
-            /*
-            ** User has chosen not to execute this command. Move to next.
-            */
-            psCmdSeq++;
-            psEntry->bCurrSeqIndex++;
+            psStep = &psEntry->asSteps[ i ];
+            break;
          }
-         else if( eStatus == ABCC_CMDSEQ_CMD_SEND )
+      }
+
+      if( psStep != NULL )
+      {
+         bSeqIndex = psStep->bSeqIndex;
+      }
+      else
+      {
+         bSeqIndex = psEntry->bCurrSeqIndex;
+
+         if( psEntry->pasCmdSeq[ bSeqIndex ].pnCmdHandler == NULL )
          {
-            psEntry->bSourceId = ABCC_GetMsgSourceId( psMsg );
-            if( !CheckAndSetState( psEntry, CMD_SEQ_STATE_ANY, CMD_SEQ_STATE_WAIT_RESP ) )
-            {
-               ABCC_LOG_FATAL( ABCC_EC_ASSERT_FAILED,
-                  0,
-                  "Failed to set command sequence state\n" );
-            }
-            (void)ABCC_SendCmdMsg( psMsg, HandleResponse );
-            fCmdBufferConsumed = TRUE;
+            break;
          }
-         else if( eStatus == ABCC_CMDSEQ_CMD_ABORT )
+
+         if( ( psEntry->bNumSteps > 0 ) &&
+             ( ( ( psEntry->pasCmdSeq[ bSeqIndex ].bFlags & ABCC_CMD_SEQ_FLAG_INDEPENDENT ) == 0 ) ||
+               ( psEntry->bNumSteps >= ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT ) ) )
          {
-            ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Aborted\n",
-                  (void*)psEntry->pasCmdSeq );
             /*
-            ** Abort move to end of sequence
+            ** Wait for the outstanding responses.
             */
-            while( (++psCmdSeq)->pnCmdHandler != NULL );
-            psEntry->eSeqResult = ABCC_CMDSEQ_RESULT_ABORT_INT;
-         }
-         else
-         {
-            ABCC_LOG_ERROR( ABCC_EC_PARAMETER_NOT_VALID,
-               (UINT32)eStatus,
-               "Bad return parameter from response handler (%d)\n",
-               eStatus );
+            break;
          }
       }
 
       /*
-      ** Check end of sequence
+      ** A reused response buffer still needs a free command queue entry when
+      ** other commands are outstanding.
       */
-      if( psCmdSeq->pnCmdHandler == NULL )
+      if( ( NumWaitingSteps( psEntry ) > 0 ) && ( ABCC_GetCmdQueueSize() == 0 ) )
+      {
+         break;
+      }
+
+      if( psMsg == NULL )
       {
-         ABCC_CmdSeqDoneHandler pnSeqDone;
-         void *pxUserData;
-         ABCC_CmdSeqResultType eSeqResult;
+         psMsg = ABCC_GetCmdMsgBuffer();
+         if( psMsg == NULL )
+         {
+            break;
+         }
+      }
+
+      psEntry->bRetryCount = 0;
+      psCmdSeq = &psEntry->pasCmdSeq[ bSeqIndex ];
 
+      ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->%s()\n",
+            (void*)psEntry->pasCmdSeq,
+            psCmdSeq->pcCmdName );
+
+      eStatus = psCmdSeq->pnCmdHandler( psMsg, psEntry->pxUserData );
+      if( eStatus == ABCC_CMDSEQ_CMD_SKIP )
+      {
+         ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Command not sent, jump to next sequence step\n",
+               (void*)psEntry->pasCmdSeq );
          /*
-         ** Free resource before calling done callback
+         ** User has chosen not to execute this command. Move to next.
          */
-         ABCC_ReturnMsgBuffer( &psMsg );
-         fCmdBufferConsumed = TRUE;
+         if( psStep != NULL )
+         {
+            RemoveStep( psEntry, (UINT8)( psStep - psEntry->asSteps ) );
+         }
+         else
+         {
+            psEntry->bCurrSeqIndex++;
+         }
+      }
+      else if( eStatus == ABCC_CMDSEQ_CMD_SEND )
+      {
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+         lDeadlineMs = 0;
+         if( psCmdSeq->iTimeoutMs != 0 )
+         {
+            lDeadlineMs = (UINT32)ABCC_TimerGetUptimeMs() +
+               StepTimeoutMs( psCmdSeq, ( psStep != NULL ) ? psStep->bNumTimeouts : 0 );
+         }
+#endif
 
-         ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Done\n",
-               (void*)psEntry->pasCmdSeq );
-         pnSeqDone = psEntry->pnSeqDone;
-         pxUserData = psEntry->pxUserData;
-         eSeqResult = psEntry->eSeqResult;
+         /*
+         ** The step must be mapped before the command is sent since the
+         ** response may be received in another context.
+         */
+         ABCC_PORT_EnterCritical();
+         if( psStep == NULL )
+         {
+            psStep = &psEntry->asSteps[ psEntry->bNumSteps ];
+            psStep->bSeqIndex = bSeqIndex;
+            psStep->psDeferredResp = NULL;
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+            psStep->bNumTimeouts = 0;
+#endif
+            psEntry->bNumSteps++;
+            psEntry->bCurrSeqIndex++;
+         }
+         psStep->bSourceId = ABCC_GetMsgSourceId( psMsg );
+         psStep->fReissue = FALSE;
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+         psStep->lDeadlineMs = lDeadlineMs;
+#endif
+         abcc_abSourceIdToEntry[ psStep->bSourceId ] = (UINT8)( psEntry - abcc_asCmdSeq );
+         ABCC_PORT_ExitCritical();
 
-         ResetCmdSeqEntry( psEntry, FALSE );
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+         if( psCmdSeq->iTimeoutMs != 0 )
+         {
+            StartStepTimer( lDeadlineMs );
+         }
+#endif
 
-         if( pnSeqDone != NULL )
+         (void)ABCC_SendCmdMsg( psMsg, HandleResponse );
+         psMsg = NULL;
+      }
+      else if( eStatus == ABCC_CMDSEQ_CMD_ABORT )
+      {
+         if( psStep != NULL )
+         {
+            RemoveStep( psEntry, (UINT8)( psStep - psEntry->asSteps ) );
+         }
+         AbortCmdSequence( psEntry );
+      }
+      else
+      {
+         ABCC_LOG_ERROR( ABCC_EC_PARAMETER_NOT_VALID,
+            (UINT32)eStatus,
+            "Bad return parameter from command handler (%d)\n",
+            eStatus );
+
+         if( psStep != NULL )
          {
-            pnSeqDone( eSeqResult, pxUserData );
+            RemoveStep( psEntry, (UINT8)( psStep - psEntry->asSteps ) );
          }
+         AbortCmdSequence( psEntry );
+      }
+   }
+
+   if( psMsg != NULL )
+   {
+      ABCC_ReturnMsgBuffer( &psMsg );
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Execute the command sequence and leave the CMD_SEQ_STATE_BUSY state. The
+** sequence is completed when all steps have been executed and no responses are
+** outstanding. Responses received in another context meanwhile are handled
+** before the entry is set to wait for responses.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psEntry - Pointer to handler in CMD_SEQ_STATE_BUSY state.
+**    psMsg   - Pointer to allocated command message buffer or NULL.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void RunCmdSequence( CmdSeqEntryType* psEntry, ABP_MsgType* psMsg )
+{
+   UINT8 bStep;
+   ABCC_CmdSeqDoneHandler pnSeqDone;
+   void *pxUserData;
+   ABCC_CmdSeqResultType eSeqResult;
+
+   while( TRUE )
+   {
+      ExecCmdSequence( psEntry, psMsg );
+
+      if( NumWaitingSteps( psEntry ) == 0 )
+      {
+         break;
+      }
+
+      psMsg = TakeDeferredResponse( psEntry, &bStep );
+      if( psMsg == NULL )
+      {
+         /*
+         ** Waiting for responses.
+         */
+         return;
+      }
+
+      if( HandleStepResponse( psEntry, bStep, psMsg ) == NULL )
+      {
+         psMsg = NULL;
+      }
+   }
+
+   if( ( psEntry->bNumSteps == 0 ) &&
+       ( psEntry->pasCmdSeq[ psEntry->bCurrSeqIndex ].pnCmdHandler == NULL ) )
+   {
+      ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Done\n",
+            (void*)psEntry->pasCmdSeq );
+      pnSeqDone = psEntry->pnSeqDone;
+      pxUserData = psEntry->pxUserData;
+      eSeqResult = psEntry->eSeqResult;
+
+      ResetCmdSeqEntry( psEntry, FALSE );
+
+      if( pnSeqDone != NULL )
+      {
+         pnSeqDone( eSeqResult, pxUserData );
       }
    }
    else
@@ -538,9 +1134,146 @@ static BOOL ExecCmdSequence( CmdSeqEntryType* psEntry, ABP_MsgType* psMsg )
             "Failed to set command sequence state\n" );
       }
    }
+}
+
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+/*------------------------------------------------------------------------------
+** Handle the steps whose response timeouts have expired. An expired step is
+** executed again if it has retries left, otherwise the sequence is ended with
+** ABCC_CMDSEQ_RESULT_TIMEOUT. The timed out commands are abandoned, which
+** releases their source ids and command queue entries. A late response is
+** then ignored by the driver.
+** Finally the step timer is started for the earliest remaining deadline.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void HandleStepTimeouts( void )
+{
+   UINT8 i;
+   UINT8 j;
+   UINT8 bStep;
+   UINT8 bNumSourceIds;
+   UINT8 abSourceId[ ABCC_CFG_CMD_SEQ_MAX_IN_FLIGHT ];
+   BOOL fTimedOut;
+   BOOL fNextDeadline;
+   UINT32 lNextDeadlineMs;
+   UINT32 lNowMs;
+   CmdSeqEntryType* psEntry;
+   CmdSeqStepType* psStep;
+   ABCC_PORT_UseCritical();
+
+   abcc_fStepTmoExpired = FALSE;
+   fNextDeadline = FALSE;
+   lNextDeadlineMs = 0;
+   lNowMs = (UINT32)ABCC_TimerGetUptimeMs();
+
+   for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
+   {
+      psEntry = &abcc_asCmdSeq[ i ];
+      bStep = CMD_SEQ_NO_STEP;
+      bNumSourceIds = 0;
+      fTimedOut = FALSE;
+
+      ABCC_PORT_EnterCritical();
+
+      /*
+      ** Only an entry waiting for responses can be taken here. Expired steps
+      ** of an entry that is busy in another context are handled at the next
+      ** timeout.
+      */
+      for( j = 0; j < psEntry->bNumSteps; j++ )
+      {
+         psStep = &psEntry->asSteps[ j ];
+
+         if( !psStep->fReissue &&
+             ( psStep->psDeferredResp == NULL ) &&
+             ( psEntry->pasCmdSeq[ psStep->bSeqIndex ].iTimeoutMs != 0 ) )
+         {
+            if( ( bStep == CMD_SEQ_NO_STEP ) &&
+                ( psEntry->eState == CMD_SEQ_STATE_WAIT_RESP ) &&
+                ( (INT32)( lNowMs - psStep->lDeadlineMs ) >= 0 ) )
+            {
+               bStep = j;
+            }
+            else if( !fNextDeadline ||
+                     ( (INT32)( psStep->lDeadlineMs - lNextDeadlineMs ) < 0 ) )
+            {
+               fNextDeadline = TRUE;
+               lNextDeadlineMs = psStep->lDeadlineMs;
+            }
+         }
+      }
+
+      if( bStep != CMD_SEQ_NO_STEP )
+      {
+         psEntry->eState = CMD_SEQ_STATE_BUSY;
+         psStep = &psEntry->asSteps[ bStep ];
+
+         if( psStep->bNumTimeouts < psEntry->pasCmdSeq[ psStep->bSeqIndex ].bNumRetries )
+         {
+            abSourceId[ bNumSourceIds++ ] = psStep->bSourceId;
+            abcc_abSourceIdToEntry[ psStep->bSourceId ] = CMD_SEQ_NO_ENTRY;
+            psStep->bNumTimeouts++;
+            psStep->fReissue = TRUE;
+         }
+         else
+         {
+            /*
+            ** No retries left, release all outstanding commands.
+            */
+            for( j = 0; j < psEntry->bNumSteps; j++ )
+            {
+               if( !psEntry->asSteps[ j ].fReissue )
+               {
+                  abSourceId[ bNumSourceIds++ ] = psEntry->asSteps[ j ].bSourceId;
+                  abcc_abSourceIdToEntry[ psEntry->asSteps[ j ].bSourceId ] = CMD_SEQ_NO_ENTRY;
+               }
+            }
+            psEntry->bNumSteps = 0;
+            fTimedOut = TRUE;
+         }
+      }
+
+      ABCC_PORT_ExitCritical();
+
+      /*
+      ** Abandoning the commands is done outside critical section to avoid
+      ** nested critical sections.
+      */
+      for( j = 0; j < bNumSourceIds; j++ )
+      {
+         ABCC_LinkAbandonCmd( abSourceId[ j ] );
+      }
+
+      if( bStep != CMD_SEQ_NO_STEP )
+      {
+         if( fTimedOut )
+         {
+            ABCC_LOG_WARNING( ABCC_EC_CMD_SEQ_TIMEOUT, 0, "Command sequence step timed out\n" );
+            AbortCmdSequence( psEntry );
+            psEntry->eSeqResult = ABCC_CMDSEQ_RESULT_TIMEOUT;
+         }
+         else
+         {
+            ABCC_LOG_DEBUG_CMD_SEQ( "CmdSeq(%p)->Response timeout, executing same sequence step again\n",
+                  (void*)psEntry->pasCmdSeq );
+         }
+
+         RunCmdSequence( psEntry, NULL );
+      }
+   }
 
-   return( fCmdBufferConsumed );
+   if( fNextDeadline )
+   {
+      StartStepTimer( lNextDeadlineMs );
+   }
 }
+#endif
 
 ABCC_ErrorCodeType ABCC_CmdSeqAdd(
    const ABCC_CmdSeqType* pasCmdSeq,
@@ -569,8 +1302,15 @@ ABCC_ErrorCodeType ABCC_CmdSeqAdd(
          *pxHandle = (ABCC_CmdSeqHandle)psEntry;
       }
 
+      if( !CheckAndSetState( psEntry, CMD_SEQ_STATE_ANY, CMD_SEQ_STATE_BUSY ) )
+      {
+         ABCC_LOG_FATAL( ABCC_EC_ASSERT_FAILED,
+            0,
+            "Failed to set command sequence state\n" );
+      }
+
       psMsg = ABCC_GetCmdMsgBuffer();
-      (void)ExecCmdSequence( psEntry, psMsg );
+      RunCmdSequence( psEntry, psMsg );
    }
    else
    {
@@ -608,55 +1348,78 @@ ABCC_ErrorCodeType ABCC_CmdSeqAbort( const ABCC_CmdSeqHandle xHandle )
 
 void ABCC_CmdSequencerInit( void )
 {
-   UINT8 i;
-   for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
+   UINT16 i;
+
+   abcc_psReadyHead = NULL;
+   abcc_psReadyTail = NULL;
+   abcc_psFreeHead = NULL;
+   abcc_iNeedReTriggerCount = 0;
+
+   for( i = 0; i < 256; i++ )
    {
-      ResetCmdSeqEntry( &abcc_asCmdSeq[ i ], TRUE );
+      abcc_abSourceIdToEntry[ i ] = CMD_SEQ_NO_ENTRY;
+   }
+
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+   abcc_fStepTmoStarted = FALSE;
+   abcc_fStepTmoExpired = FALSE;
+   abcc_xStepTmoHandle = ABCC_TimerCreate( StepTimerTimeout );
+#endif
+
+   /*
+   ** Reset in reverse order to get the first entry first in the free list.
+   */
+   for( i = ABCC_CFG_MAX_NUM_CMD_SEQ; i > 0; i-- )
+   {
+      ResetCmdSeqEntry( &abcc_asCmdSeq[ i - 1 ], TRUE );
    }
-   abcc_iNeedReTriggerCount = 0;
 }
 
 void ABCC_CmdSequencerExec( void )
 {
-   UINT8 i;
-   ABP_MsgType* psMsg;
+   UINT16 iNumReady;
+   CmdSeqEntryType* psEntry;
+   ABCC_PORT_UseCritical();
+
+#if ABCC_CFG_CMD_SEQ_STEP_TIMEOUT_ENABLED
+   if( abcc_fStepTmoExpired )
+   {
+      HandleStepTimeouts();
+   }
+#endif
 
    /*
-   ** Only execute if any sequence requires re-trigger.
+   ** Only the entries queued when the call is made are re-triggered. An entry
+   ** that has to be re-triggered again is queued last and handled in the next
+   ** call.
    */
-   if( abcc_iNeedReTriggerCount > 0 )
+   iNumReady = abcc_iNeedReTriggerCount;
+
+   while( iNumReady > 0 )
    {
-      psMsg = NULL;
+      iNumReady--;
 
-      for( i = 0; i < ABCC_CFG_MAX_NUM_CMD_SEQ; i++ )
+      ABCC_PORT_EnterCritical();
+      psEntry = abcc_psReadyHead;
+      if( psEntry != NULL )
       {
-         if( CheckAndSetState( &abcc_asCmdSeq[ i ], CMD_SEQ_STATE_RETRIGGER, CMD_SEQ_STATE_BUSY ) )
-         {
-            abcc_asCmdSeq[ i ].bRetryCount++;
-            if( abcc_asCmdSeq[ i ].bRetryCount > ABCC_CFG_CMD_SEQ_MAX_NUM_RETRIES )
-            {
-               ABCC_LOG_WARNING( ABCC_EC_CMD_SEQ_RETRY_LIMIT, 0, "Command sequence retry limit reached\n" );
-            }
-
-            if( psMsg == NULL )
-            {
-               psMsg = ABCC_GetCmdMsgBuffer();
-            }
+         UnlinkReady( psEntry );
+         psEntry->eState = CMD_SEQ_STATE_BUSY;
+      }
+      ABCC_PORT_ExitCritical();
 
-            if( ExecCmdSequence( &abcc_asCmdSeq[ i ], psMsg ) == TRUE )
-            {
-               /*
-               ** Message buffer consumed
-               */
-               psMsg = NULL;
-            }
-         }
+      if( psEntry == NULL )
+      {
+         break;
       }
 
-      if( psMsg != NULL )
+      psEntry->bRetryCount++;
+      if( psEntry->bRetryCount > ABCC_CFG_CMD_SEQ_MAX_NUM_RETRIES )
       {
-         ABCC_ReturnMsgBuffer( &psMsg );
+         ABCC_LOG_WARNING( ABCC_EC_CMD_SEQ_RETRY_LIMIT, 0, "Command sequence retry limit reached\n" );
       }
+
+      RunCmdSequence( psEntry, NULL );
    }
 }
 #endif
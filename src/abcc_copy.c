@@ -11,23 +11,54 @@
 #include "abcc.h"
 
 #ifdef ABCC_SYS_16_BIT_CHAR
+/*------------------------------------------------------------------------------
+** Word helpers for the copy functions below. Each word holds two octets.
+**
+** COPY_SHIFT_MERGE() returns the word made of the high address octet of
+** iFirst followed by the low address octet of iSecond, i.e. a word read from
+** an odd octet offset.
+**
+** COPY_PACK() returns the word made of the octet values iLow and iHigh, in
+** address order.
+**------------------------------------------------------------------------------
+*/
+#ifdef ABCC_SYS_BIG_ENDIAN
+#define COPY_SHIFT_MERGE( iFirst, iSecond )                                   \
+        (UINT16)( ( (UINT16)(iFirst) << 8 ) | ( (UINT16)(iSecond) >> 8 ) )
+#define COPY_PACK( iLow, iHigh )                                              \
+        (UINT16)( ( (UINT16)(iLow) << 8 ) | ( (UINT16)(iHigh) & 0x00FF ) )
+#else
+#define COPY_SHIFT_MERGE( iFirst, iSecond )                                   \
+        (UINT16)( ( (UINT16)(iFirst) >> 8 ) | ( (UINT16)(iSecond) << 8 ) )
+#define COPY_PACK( iLow, iHigh )                                              \
+        (UINT16)( ( (UINT16)(iLow) & 0x00FF ) | ( (UINT16)(iHigh) << 8 ) )
+#endif
+
 void ABCC_CopyOctetsImpl( void* pxDest, UINT16 iDestOctetOffset,
                           const void* pxSrc, UINT16 iSrcOctetOffset,
                           UINT16 iNumOctets )
 {
-   UINT16 i;
+   UINT16 iNumWords;
    UINT16 iData;
-   BOOL fOddDestOctet;
+   UINT16 iNext;
    BOOL fOddSrcOctet;
    UINT16* piDest;
-   UINT16* piSrc;
+   const UINT16* piSrc;
 
-   fOddDestOctet = iDestOctetOffset & 1;
-   fOddSrcOctet =  iSrcOctetOffset & 1;
-   piDest =   (UINT16*)pxDest + ( iDestOctetOffset >> 1 );
-   piSrc =    (UINT16*)pxSrc + ( iSrcOctetOffset >> 1 );
+   if( iNumOctets == 0 )
+   {
+      return;
+   }
+
+   fOddSrcOctet = iSrcOctetOffset & 1;
+   piDest = (UINT16*)pxDest + ( iDestOctetOffset >> 1 );
+   piSrc = (const UINT16*)pxSrc + ( iSrcOctetOffset >> 1 );
 
-   for( i = 0; i < iNumOctets; i++ )
+   /*
+   ** Head. Fill the high address octet of the first destination word so that
+   ** the rest of the copy starts at a word boundary in the destination.
+   */
+   if( iDestOctetOffset & 1 )
    {
       if( fOddSrcOctet )
       {
@@ -40,16 +71,56 @@ void ABCC_CopyOctetsImpl( void* pxDest, UINT16 iDestOctetOffset,
       }
       fOddSrcOctet ^= 1;
 
-      if( fOddDestOctet )
+      ABCC_SetHighAddrOct( *piDest, iData );
+      piDest++;
+      iNumOctets--;
+   }
+
+   iNumWords = iNumOctets >> 1;
+
+   if( !fOddSrcOctet )
+   {
+      /*
+      ** Same parity, copy whole words.
+      */
+      while( iNumWords > 0 )
       {
-         ABCC_SetHighAddrOct( *piDest, iData );
-         piDest++;
+         *piDest++ = *piSrc++;
+         iNumWords--;
+      }
+   }
+   else
+   {
+      /*
+      ** Different parity, each destination word is made of two adjacent
+      ** source words. Every source word is only read once.
+      */
+      iData = *piSrc;
+      while( iNumWords > 0 )
+      {
+         iNext = *++piSrc;
+         *piDest++ = COPY_SHIFT_MERGE( iData, iNext );
+         iData = iNext;
+         iNumWords--;
+      }
+   }
+
+   /*
+   ** Tail. One octet left for the low address octet of the last destination
+   ** word.
+   */
+   if( iNumOctets & 1 )
+   {
+      if( fOddSrcOctet )
+      {
+         iData = ABCC_GetHighAddrOct( *piSrc );
       }
       else
       {
-         ABCC_SetLowAddrOct( *piDest, iData );
+         iData = ABCC_GetLowAddrOct( *piSrc );
       }
-      fOddDestOctet ^= 1;
+
+      ABCC_SetLowAddrOct( *piDest, iData );
    }
 }
 
@@ -58,27 +129,45 @@ void ABCC_StrCpyToNativeImpl( void* pxDest, const void* pxSrc,
 {
    UINT16*        piDest;
    const UINT16*  piSrc;
-   BOOL           fOddSrc;
+   UINT16         iData;
+
+   if( iNbrOfChars == 0 )
+   {
+      return;
+   }
 
    piDest = pxDest;
-   piSrc = (UINT16*)pxSrc + ( iSrcOctetOffset >> 1 );
-   fOddSrc = ( iSrcOctetOffset & 1 ) == 1;
+   piSrc = (const UINT16*)pxSrc + ( iSrcOctetOffset >> 1 );
 
-   while( iNbrOfChars > 0 )
+   /*
+   ** Head. Odd source offset, take the high address octet first.
+   */
+   if( iSrcOctetOffset & 1 )
    {
-      if( fOddSrc )
-      {
-         *piDest = ABCC_GetHighAddrOct( *piSrc );
-         piSrc++;
-      }
-      else
-      {
-         *piDest = ABCC_GetLowAddrOct( *piSrc );
-      }
-      piDest++;
-      fOddSrc = !fOddSrc;
+      *piDest++ = ABCC_GetHighAddrOct( *piSrc );
+      piSrc++;
       iNbrOfChars--;
    }
+
+   /*
+   ** Unpack two characters per source word.
+   */
+   while( iNbrOfChars >= 2 )
+   {
+      iData = *piSrc++;
+      piDest[ 0 ] = ABCC_GetLowAddrOct( iData );
+      piDest[ 1 ] = ABCC_GetHighAddrOct( iData );
+      piDest += 2;
+      iNbrOfChars -= 2;
+   }
+
+   /*
+   ** Tail.
+   */
+   if( iNbrOfChars > 0 )
+   {
+      *piDest = ABCC_GetLowAddrOct( *piSrc );
+   }
 }
 
 void ABCC_StrCpyToPackedImpl( void* pxDest, UINT16 iDestOctetOffset,
@@ -86,27 +175,43 @@ void ABCC_StrCpyToPackedImpl( void* pxDest, UINT16 iDestOctetOffset,
 {
    UINT16*        piDest;
    const UINT16*  piSrc;
-   BOOL           fOddDest;
+
+   if( iNbrOfChars == 0 )
+   {
+      return;
+   }
 
    piDest = (UINT16*)pxDest + ( iDestOctetOffset >> 1 );
    piSrc = pxSrc;
-   fOddDest = ( iDestOctetOffset & 1 ) == 1;
 
-   while( iNbrOfChars > 0 )
+   /*
+   ** Head. Odd destination offset, fill the high address octet first.
+   */
+   if( iDestOctetOffset & 1 )
    {
-      if( fOddDest )
-      {
-         ABCC_SetHighAddrOct( *piDest, *piSrc );
-         piDest++;
-      }
-      else
-      {
-         ABCC_SetLowAddrOct( *piDest, *piSrc );
-      }
+      ABCC_SetHighAddrOct( *piDest, *piSrc );
+      piDest++;
       piSrc++;
-      fOddDest = !fOddDest;
       iNbrOfChars--;
    }
+
+   /*
+   ** Pack two characters per destination word.
+   */
+   while( iNbrOfChars >= 2 )
+   {
+      *piDest++ = COPY_PACK( piSrc[ 0 ], piSrc[ 1 ] );
+      piSrc += 2;
+      iNbrOfChars -= 2;
+   }
+
+   /*
+   ** Tail.
+   */
+   if( iNbrOfChars > 0 )
+   {
+      ABCC_SetLowAddrOct( *piDest, *piSrc );
+   }
 }
 #else
 #if ABCC_CFG_PAR_EXT_BUS_ENDIAN_DIFF
@@ -356,6 +356,29 @@ EXTFUNC void ( *pnABCC_DrvSetAppStatus )( ABP_AppStatusType eAppStatus );
 EXTFUNC void ( *pnABCC_DrvSetPdSize )( const UINT16 iReadPdSize,
                                        const UINT16 iWritePdSize );
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*------------------------------------------------------------------------------
+** Prepares the process data sizes to use after a remap. The driver calculates
+** the new layout in advance and switches to it on the frame boundary where
+** psRemapRespMsg has been sent to the ABCC. Process data is exchanged with the
+** current layout up to that point, so cyclic data is not stalled by the
+** remap.
+** A NULL message cancels a prepared remap.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psRemapRespMsg - Remap response message that triggers the switch.
+**    iReadPdSize    - Size of read process data after the remap (bytes)
+**    iWritePdSize   - Size of write process data after the remap (bytes)
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ( *pnABCC_DrvPrepareRemap )( const ABP_MsgType* psRemapRespMsg,
+                                          const UINT16 iReadPdSize,
+                                          const UINT16 iWritePdSize );
+#endif
+
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
 /*------------------------------------------------------------------------------
 ** Sets the new message fragment size (used for SPI, only).
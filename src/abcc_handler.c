@@ -18,6 +18,7 @@
 #include "abcc_memory.h"
 #include "abcc_hardware_abstraction.h"
 #include "abcc_log.h"
+#include "abcc_trace.h"
 #include "abcc_handler.h"
 #include "abcc_timer.h"
 #include "abcc_setup.h"
@@ -88,6 +89,9 @@ BOOL ( *pnABCC_DrvISReadyForCmd )( void );
 void ( *pnABCC_DrvSetNbrOfCmds )( UINT8 bNbrOfCmds );
 void ( *pnABCC_DrvSetAppStatus )( ABP_AppStatusType eAppStatus );
 void ( *pnABCC_DrvSetPdSize )( const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+void ( *pnABCC_DrvPrepareRemap )( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+#endif
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
 ABCC_ErrorCodeType( *pnABCC_DrvNewMsgFragSize )( const UINT16 iReqMsgFragSize );
 #endif // ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
@@ -418,6 +422,9 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       pnABCC_DrvSetNbrOfCmds       = &ABCC_DrvSerSetNbrOfCmds;
       pnABCC_DrvSetAppStatus       = &ABCC_DrvSerSetAppStatus;
       pnABCC_DrvSetPdSize          = &ABCC_DrvSerSetPdSize;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+      pnABCC_DrvPrepareRemap       = &ABCC_DrvSerPrepareRemap;
+#endif
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
       pnABCC_DrvNewMsgFragSize     = &ABCC_DoNothing;
 #endif // ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
@@ -457,6 +464,9 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       pnABCC_DrvSetNbrOfCmds       = &ABCC_DrvSpiSetNbrOfCmds;
       pnABCC_DrvSetAppStatus       = &ABCC_DrvSpiSetAppStatus;
       pnABCC_DrvSetPdSize          = &ABCC_DrvSpiSetPdSize;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+      pnABCC_DrvPrepareRemap       = &ABCC_DrvSpiPrepareRemap;
+#endif
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
       pnABCC_DrvNewMsgFragSize     = &ABCC_DrvSpiNewMsgFragSize;
 #endif // ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
@@ -497,6 +507,9 @@ ABCC_ErrorCodeType ABCC_StartDriver( UINT32 lMaxStartupTimeMs )
       pnABCC_DrvSetNbrOfCmds       = &ABCC_DrvParSetNbrOfCmds;
       pnABCC_DrvSetAppStatus       = &ABCC_DrvParSetAppStatus;
       pnABCC_DrvSetPdSize          = &ABCC_DrvParSetPdSize;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+      pnABCC_DrvPrepareRemap       = &ABCC_DrvParPrepareRemap;
+#endif
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
       pnABCC_DrvNewMsgFragSize     = &ABCC_DoNothing;
 #endif // ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
@@ -719,6 +732,7 @@ void ABCC_TriggerReceiveMessage ( void )
    }
 
    ABCC_LOG_DEBUG_HEXDUMP_MSG_RX( sRdMsg.psMsg );
+   ABCC_TRACE_MSG_RX( sRdMsg.psMsg );
    ABCC_LOG_DEBUG_MSG_CONTENT( sRdMsg.psMsg, "Msg received\n" );
    /*
    ** Set buffer status to indicate that the buffer is handed over to the
@@ -779,11 +793,13 @@ void ABCC_TriggerReceiveMessage ( void )
          if( pnMsgHandler )
          {
             ABCC_LOG_DEBUG_MSG_EVENT( sRdMsg.psMsg, "Routing response to registered response handler: " );
+            ABCC_TRACE_MSG_EVENT( sRdMsg.psMsg, ABCC_TRACE_EVENT_RESP_ROUTED );
             pnMsgHandler( sRdMsg.psMsg );
          }
          else
          {
             ABCC_LOG_DEBUG_MSG_EVENT( sRdMsg.psMsg, "No response handler found" );
+            ABCC_TRACE_MSG_EVENT( sRdMsg.psMsg, ABCC_TRACE_EVENT_RESP_NO_HANDLER );
          }
       }
    }
@@ -798,6 +814,40 @@ void ABCC_TriggerReceiveMessage ( void )
    }
 }
 
+#if ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
+BOOL ABCC_HandleResponseInPlace( ABP_MsgType* psMsg )
+{
+   ABCC_MsgType sRdMsg;
+
+   sRdMsg.psMsg = psMsg;
+
+   /*
+   ** Messages exceeding ABCC_CFG_MAX_MSG_SIZE are reported by the ordinary
+   ** receive path.
+   */
+   if( ABCC_GetMsgDataSize( sRdMsg.psMsg ) > ABCC_CFG_MAX_MSG_SIZE )
+   {
+      return( FALSE );
+   }
+
+   if( !ABCC_CbfHandleResponseInPlace( sRdMsg.psMsg ) )
+   {
+      return( FALSE );
+   }
+
+   ABCC_LOG_DEBUG_MSG_CONTENT( sRdMsg.psMsg, "Msg handled in place\n" );
+
+   /*
+   ** The response never reaches ABCC_LinkReadMessage(), release the command
+   ** queue entry and the message handler resource here.
+   */
+   ABCC_LinkCompleteCmd( ABCC_GetLowAddrOct( sRdMsg.psMsg16->sHeader.iSourceIdDestObj ) );
+   (void)ABCC_LinkGetMsgHandler( ABCC_GetLowAddrOct( sRdMsg.psMsg16->sHeader.iSourceIdDestObj ) );
+
+   return( TRUE );
+}
+#endif
+
 ABCC_ErrorCodeType ABCC_SendCmdMsg( ABP_MsgType*  psCmdMsg, ABCC_MsgHandlerFuncType pnMsgHandler )
 {
    ABCC_ErrorCodeType eResult;
@@ -880,6 +930,17 @@ void ABCC_SetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize )
    pnABCC_DrvSetPdSize( iReadPdSize, iWritePdSize );
 }
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+void ABCC_PrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize )
+{
+   if( psRemapRespMsg != NULL )
+   {
+      ABCC_LOG_INFO( "New process data sizes after remap RdPd %" PRIu16 " WrPd %" PRIu16 "\n", iReadPdSize, iWritePdSize );
+   }
+   pnABCC_DrvPrepareRemap( psRemapRespMsg, iReadPdSize, iWritePdSize );
+}
+#endif
+
 ABCC_ErrorCodeType ABCC_RunDriver( void )
 {
    if( abcc_eMainState == ABCC_DRV_ERROR )
@@ -936,6 +997,18 @@ UINT16 ABCC_ModCap( void )
    return( pnABCC_DrvGetModCap() );
 }
 
+#if ABCC_CFG_DRV_PARALLEL_ENABLED && ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+ABCC_ErrorCodeType ABCC_AddReadPdRange( UINT16 iOffset, UINT16 iSize )
+{
+   return( ABCC_DrvParAddRdPdRange( iOffset, iSize ) );
+}
+
+void ABCC_ClearReadPdRanges( void )
+{
+   ABCC_DrvParClearRdPdRanges();
+}
+#endif
+
 UINT16 ABCC_LedStatus( void )
 {
    return( pnABCC_DrvGetLedStatus() );
@@ -990,6 +1063,16 @@ UINT64 ABCC_GetUptimeMs( void )
    return( ABCC_TimerGetUptimeMs() );
 }
 
+UINT64 ABCC_GetUptimeUs( void )
+{
+   return( ABCC_TimerGetUptimeUs() );
+}
+
+UINT32 ABCC_GetTimerNextDeadlineMs( void )
+{
+   return( ABCC_TimerNextDeadlineMs() );
+}
+
 UINT8 ABCC_GetNewSourceId( void )
 {
    static UINT8 bSourceId = 0;
@@ -61,6 +61,27 @@ EXTVAR UINT16 ABCC_iInterruptEnableMask;
 */
 EXTFUNC void ABCC_SetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize );
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*------------------------------------------------------------------------------
+** ABCC_PrepareRemap()
+** Prepares the process data sizes to use after a remap. The driver switches
+** to them on the frame boundary where the remap response has been sent.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psRemapRespMsg    - Remap response message, NULL cancels a prepared
+**                           remap.
+**       iReadPdSize       - Size of the read process data (in bytes) after
+**                           the remap.
+**       iWritePdSize      - Size of the write process data (in bytes) after
+**                           the remap.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_PrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+#endif
+
 /*------------------------------------------------------------------------------
 ** The anybus is ready for communication. This function shall be called either
 ** due to power up interrupt or initial handshake timeout
@@ -114,4 +135,23 @@ EXTFUNC ABCC_MainStateType ABCC_GetMainState( void );
 */
 EXTFUNC void ABCC_CheckWrPdUpdate( void );
 
+#if ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
+/*------------------------------------------------------------------------------
+** Offers a received response message, located in the read message area of the
+** ABCC, to ABCC_CbfHandleResponseInPlace(). Releases the response handler if
+** the application handled the response.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psMsg - Pointer to the response message in the read message area.
+**
+** Returns:
+**       TRUE  - The response is handled and the read message area can be
+**               released.
+**       FALSE - The response shall be copied to a message buffer and handled
+**               as usual.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC BOOL ABCC_HandleResponseInPlace( ABP_MsgType* psMsg );
+#endif
+
 #endif  /* inclusion lock */
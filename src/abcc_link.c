@@ -8,9 +8,12 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_LINK
+
 #include "abcc_config.h"
 #include "abcc_types.h"
 #include "abcc_log.h"
+#include "abcc_trace.h"
 #include "abcc.h"
 #include "abcc_link.h"
 #include "abcc_driver_interface.h"
@@ -77,6 +80,15 @@ static MsgQueueType link_sRespQueue;
 */
 static ABCC_MsgHandlerFuncType link_pnMsgHandler[ LINK_MAX_NUM_MSG_HDL ];
 static UINT8              link_bMsgSrcId[ LINK_MAX_NUM_MSG_HDL ];
+static BOOL               link_afMsgRespReceived[ LINK_MAX_NUM_MSG_HDL ];
+
+/*
+** Source ids of commands abandoned with ABCC_LinkAbandonCmd() that have not
+** been responded to yet, one bit per source id.
+*/
+static UINT8 link_abAbandonedSrcId[ 256 / 8 ];
+
+#define LINK_SRC_ID_BIT( bSrcId )   ( (UINT8)( 1 << ( ( bSrcId ) & 7 ) ) )
 
 static ABCC_LinkNotifyIndType pnMsgSentHandler;
 static ABP_MsgType* link_psNotifyMsg;
@@ -161,6 +173,11 @@ void ABCC_LinkInit( void )
       link_bMsgSrcId[iCount ] = 0;
    }
 
+   for( iCount = 0; iCount < sizeof( link_abAbandonedSrcId ); iCount++ )
+   {
+      link_abAbandonedSrcId[ iCount ] = 0;
+   }
+
    /*
    ** Initialize driver privates and states to default values.
    */
@@ -185,7 +202,6 @@ void ABCC_LinkInit( void )
 ABP_MsgType* ABCC_LinkReadMessage( void )
 {
    ABCC_MsgType psReadMessage;
-   ABCC_PORT_UseCritical();
 
    psReadMessage.psMsg = pnABCC_DrvReadMessage();
 
@@ -196,17 +212,54 @@ ABP_MsgType* ABCC_LinkReadMessage( void )
          /*
          ** Decrement number of outstanding commands if a response is received
          */
-         ABCC_PORT_EnterCritical();
-         link_bNumberOfOutstandingCommands--;
-         ABCC_PORT_ExitCritical();
-         ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu8 "\n",
-                                     link_bNumberOfOutstandingCommands );
+         ABCC_LinkCompleteCmd( ABCC_GetLowAddrOct( psReadMessage.psMsg16->sHeader.iSourceIdDestObj ) );
       }
    }
    return( psReadMessage.psMsg );
 }
 
 
+void ABCC_LinkCompleteCmd( UINT8 bSrcId )
+{
+   UINT16 iIndex;
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   if( link_abAbandonedSrcId[ bSrcId >> 3 ] & LINK_SRC_ID_BIT( bSrcId ) )
+   {
+      /*
+      ** Late response to an abandoned command, the queue entry has already
+      ** been released.
+      */
+      link_abAbandonedSrcId[ bSrcId >> 3 ] &= (UINT8)~LINK_SRC_ID_BIT( bSrcId );
+   }
+   else
+   {
+      if( link_bNumberOfOutstandingCommands > 0 )
+      {
+         link_bNumberOfOutstandingCommands--;
+      }
+
+      /*
+      ** Tell ABCC_LinkAbandonCmd() that the queue entry has been released in
+      ** case the command is abandoned before its handler is taken.
+      */
+      for( iIndex = 0; iIndex < LINK_MAX_NUM_MSG_HDL; iIndex++ )
+      {
+         if( ( link_pnMsgHandler[ iIndex ] != NULL ) && ( link_bMsgSrcId[ iIndex ] == bSrcId ) )
+         {
+            link_afMsgRespReceived[ iIndex ] = TRUE;
+            break;
+         }
+      }
+   }
+   ABCC_PORT_ExitCritical();
+
+   ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu8 "\n",
+                               link_bNumberOfOutstandingCommands );
+}
+
+
 void ABCC_LinkCheckSendMessage( void )
 {
    BOOL fMsgWritten;
@@ -238,6 +291,7 @@ void ABCC_LinkCheckSendMessage( void )
          link_fDrvWriteMsgLock = TRUE;
          psWriteMessage = link_DeQueue( &link_sRespQueue );
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMessage, "Response dequeued: " );
+         ABCC_TRACE_MSG_EVENT( psWriteMessage, ABCC_TRACE_EVENT_RESP_DEQUEUED );
          ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu8 "(%" PRIu8 ")\n",
                link_sRespQueue.bNumInQueue,
                link_sRespQueue.bQueueSize );
@@ -252,6 +306,7 @@ void ABCC_LinkCheckSendMessage( void )
          link_fDrvWriteMsgLock = TRUE;
          psWriteMessage = link_DeQueue( &link_sCmdQueue );
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMessage, "Command dequeued: " );
+         ABCC_TRACE_MSG_EVENT( psWriteMessage, ABCC_TRACE_EVENT_CMD_DEQUEUED );
          ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu8 "(%" PRIu8 ")\n",
                link_sCmdQueue.bNumInQueue,
                link_sCmdQueue.bQueueSize );
@@ -287,6 +342,7 @@ void ABCC_LinkCheckSendMessage( void )
          ** The message was successfully written and can be deallocated now.
          */
          ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psWriteMessage );
+         ABCC_TRACE_MSG_TX( psWriteMessage );
          ABCC_LOG_DEBUG_MSG_CONTENT( psWriteMessage, "Msg sent\n" );
          link_CheckNotification( psWriteMessage );
          ABCC_LinkFree( &psWriteMessage );
@@ -306,6 +362,7 @@ void ABCC_LinkRunDriverRx( void )
    if( psSentMsg )
    {
       ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psSentMsg );
+      ABCC_TRACE_MSG_TX( psSentMsg );
       ABCC_LOG_DEBUG_MSG_CONTENT( psSentMsg, "Msg sent\n" );
       link_CheckNotification( psSentMsg );
       ABCC_LinkFree( &psSentMsg );
@@ -326,14 +383,14 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
    BOOL fSendMsg;
    BOOL fMsgWritten;
    ABCC_ErrorCodeType eErrorCode;
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
    UINT32 lAddErrorInfo;
 #endif
 
    ABCC_PORT_UseCritical();
 
    eErrorCode = ABCC_EC_NO_ERROR;
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
    lAddErrorInfo = 0;
 #endif
    fSendMsg = FALSE;
@@ -367,6 +424,7 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
       else if( link_EnQueue( &link_sRespQueue, psWriteMsg ) )
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Response msg queued: " );
+         ABCC_TRACE_MSG_EVENT( psWriteMsg, ABCC_TRACE_EVENT_RESP_QUEUED );
          ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu8 "(%" PRIu8 ")\n",
                link_sRespQueue.bNumInQueue,
                link_sRespQueue.bQueueSize );
@@ -374,11 +432,12 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
       else
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Response queue full: " );
+         ABCC_TRACE_MSG_EVENT( psWriteMsg, ABCC_TRACE_EVENT_RESP_QUEUE_FULL );
          ABCC_LOG_DEBUG_MSG_GENERAL( "RespQ status: %" PRIu8 "(%" PRIu8 ")\n",
                link_sRespQueue.bNumInQueue,
                link_sRespQueue.bQueueSize );
          eErrorCode = ABCC_EC_LINK_RESP_QUEUE_FULL;
-#if ABCC_CFG_LOG_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
+#if ABCC_LOG_MODULE_SEVERITY >= ABCC_LOG_SEVERITY_WARNING_ENABLED
          lAddErrorInfo = (UINT32)psWriteMsg;
 #endif
       }
@@ -401,6 +460,7 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
       else if( link_EnQueue( &link_sCmdQueue, psWriteMsg ) )
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Command queued: " );
+         ABCC_TRACE_MSG_EVENT( psWriteMsg, ABCC_TRACE_EVENT_CMD_QUEUED );
          ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu8 "(%" PRIu8 ")\n",
             link_sCmdQueue.bNumInQueue,
             link_sCmdQueue.bQueueSize );
@@ -412,6 +472,7 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
       else
       {
          ABCC_LOG_DEBUG_MSG_EVENT( psWriteMsg, "Command queue full: " );
+         ABCC_TRACE_MSG_EVENT( psWriteMsg, ABCC_TRACE_EVENT_CMD_QUEUE_FULL );
          ABCC_LOG_DEBUG_MSG_GENERAL( "CmdQ status: %" PRIu8 "(%" PRIu8 ")\n",
             link_sCmdQueue.bNumInQueue,
             link_sCmdQueue.bQueueSize );
@@ -461,6 +522,7 @@ ABCC_ErrorCodeType ABCC_LinkWriteMessage( ABP_MsgType* psWriteMsg )
          ** The message was successfully written and can be deallocated now.
          */
          ABCC_LOG_DEBUG_HEXDUMP_MSG_TX( psWriteMsg );
+         ABCC_TRACE_MSG_TX( psWriteMsg );
          ABCC_LOG_DEBUG_MSG_CONTENT( psWriteMsg, "Msg sent\n" );
          link_CheckNotification( psWriteMsg );
          ABCC_LinkFree( &psWriteMsg );
@@ -531,6 +593,7 @@ ABCC_ErrorCodeType ABCC_LinkMapMsgHandler( UINT8 bSrcId, ABCC_MsgHandlerFuncType
       {
          link_pnMsgHandler[ iIndex ] = pnMSgHandler;
          link_bMsgSrcId[ iIndex ] = bSrcId;
+         link_afMsgRespReceived[ iIndex ] = FALSE;
          eResult = ABCC_EC_NO_ERROR;
          break;
       }
@@ -562,11 +625,53 @@ ABCC_MsgHandlerFuncType ABCC_LinkGetMsgHandler( UINT8 bSrcId )
    return( pnHandler );
 }
 
+void ABCC_LinkAbandonCmd( UINT8 bSrcId )
+{
+   UINT16 iIndex;
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   for( iIndex = 0; iIndex < LINK_MAX_NUM_MSG_HDL; iIndex++ )
+   {
+      if( ( link_pnMsgHandler[ iIndex ] != NULL ) && ( link_bMsgSrcId[ iIndex ] == bSrcId ) )
+      {
+         link_pnMsgHandler[ iIndex ] = NULL;
+
+         if( !link_afMsgRespReceived[ iIndex ] )
+         {
+            /*
+            ** Release the queue entry now and ignore it when the response
+            ** arrives.
+            */
+            link_abAbandonedSrcId[ bSrcId >> 3 ] |= LINK_SRC_ID_BIT( bSrcId );
+
+            if( link_bNumberOfOutstandingCommands > 0 )
+            {
+               link_bNumberOfOutstandingCommands--;
+            }
+         }
+         break;
+      }
+   }
+   ABCC_PORT_ExitCritical();
+
+   ABCC_LOG_DEBUG_MSG_GENERAL( "Outstanding commands: %" PRIu8 "\n",
+                               link_bNumberOfOutstandingCommands );
+}
+
 BOOL ABCC_LinkIsSrcIdUsed( UINT8 bSrcId )
 {
    BOOL fFound = FALSE;
    UINT16 iIndex;
 
+   /*
+   ** An abandoned source id is not reused until its response has arrived.
+   */
+   if( link_abAbandonedSrcId[ bSrcId >> 3 ] & LINK_SRC_ID_BIT( bSrcId ) )
+   {
+      return( TRUE );
+   }
+
    for( iIndex = 0; iIndex < LINK_MAX_NUM_MSG_HDL; iIndex++ )
    {
       if( ( link_pnMsgHandler[ iIndex ] != NULL ) && ( link_bMsgSrcId[ iIndex ] == bSrcId ) )
@@ -143,6 +143,35 @@ EXTFUNC BOOL ABCC_LinkIsSrcIdUsed( UINT8 bSrcId );
 */
 EXTFUNC ABP_MsgType* ABCC_LinkReadMessage( void );
 
+/*------------------------------------------------------------------------------
+** Releases the command queue entry of a command whose response has been
+** received. Called by ABCC_LinkReadMessage() and for responses that are
+** consumed by the driver without being returned by ABCC_LinkReadMessage().
+**------------------------------------------------------------------------------
+** Arguments:
+**         bSrcId:        Source id of the response.
+**
+** Returns:
+**         None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_LinkCompleteCmd( UINT8 bSrcId );
+
+/*------------------------------------------------------------------------------
+** Abandons a command that is still waiting for its response, e.g. after a
+** response timeout. The message handler and the command queue entry are
+** released at once. The source id is not reused until the late response has
+** been received, the response is then passed on without a message handler.
+**------------------------------------------------------------------------------
+** Arguments:
+**         bSrcId:        Source id of the command.
+**
+** Returns:
+**         None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_LinkAbandonCmd( UINT8 bSrcId );
+
 /*------------------------------------------------------------------------------
 ** Check queues for write messages
 **------------------------------------------------------------------------------
@@ -20,6 +20,10 @@
 #include "abcc_log.h"
 #include "abcc_handler.h"
 
+#if ABCC_CFG_LOG_BINARY_ENABLED && ABCC_CFG_LOG_STRINGS_ENABLED
+#include <stddef.h>
+#endif
+
 /*------------------------------------------------------------------------------
 ** ANSI color codes for prettier prints
 **------------------------------------------------------------------------------
@@ -52,7 +56,11 @@
 */
 #define ABCC_LOG_SEVERITY_LENGTH 10
 #define ABCC_LOG_MAX_FILE_LINE_LENGTH 37
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+#define ABCC_LOG_TIMESTAMP_LENGTH 18
+#else
 #define ABCC_LOG_TIMESTAMP_LENGTH 15
+#endif
 
 #if ABCC_CFG_LOG_TIMESTAMPS_ENABLED && ABCC_CFG_LOG_FILE_LINE_ENABLED
 #define ABCC_LOG_INDENTATION ( ABCC_LOG_SEVERITY_LENGTH + ABCC_LOG_MAX_FILE_LINE_LENGTH + ABCC_LOG_TIMESTAMP_LENGTH )
@@ -64,45 +72,119 @@
 #define ABCC_LOG_INDENTATION ( ABCC_LOG_SEVERITY_LENGTH )
 #endif
 
-void ABCC_LogHandler(
-   ABCC_LogSeverityType eSeverity,
-   ABCC_ErrorCodeType eErrorCode,
-   UINT32 lAdditionalInfo
-#if ABCC_CFG_LOG_FILE_LINE_ENABLED
-   , const char *pcFilename,
-   int xLine
-#endif
-#if ABCC_CFG_LOG_STRINGS_ENABLED
-   , const char* pcFormat,
-   ...
-#endif
-)
+static const char* const abcc_apcSeverityToString[] =
 {
-   const char* apcSeverityToString[] =
-   {
-      ".."ABCC_LOG_ANSI_COLOR_RED    "|FATAL| "ABCC_LOG_ANSI_COLOR_RESET,
-      ".."ABCC_LOG_ANSI_COLOR_RED    "|ERROR| "ABCC_LOG_ANSI_COLOR_RESET,
-      ""ABCC_LOG_ANSI_COLOR_YELLOW "|WARNING| "ABCC_LOG_ANSI_COLOR_RESET,
-      "..."ABCC_LOG_ANSI_COLOR_CYAN   "|INFO| "ABCC_LOG_ANSI_COLOR_RESET,
-      ".."ABCC_LOG_ANSI_COLOR_MAGENTA"|DEBUG| "ABCC_LOG_ANSI_COLOR_RESET,
-      ""ABCC_LOG_ANSI_COLOR_RED    "|UNKNOWN| "ABCC_LOG_ANSI_COLOR_RESET
-   };
+   ".."ABCC_LOG_ANSI_COLOR_RED    "|FATAL| "ABCC_LOG_ANSI_COLOR_RESET,
+   ".."ABCC_LOG_ANSI_COLOR_RED    "|ERROR| "ABCC_LOG_ANSI_COLOR_RESET,
+   ""ABCC_LOG_ANSI_COLOR_YELLOW "|WARNING| "ABCC_LOG_ANSI_COLOR_RESET,
+   "..."ABCC_LOG_ANSI_COLOR_CYAN   "|INFO| "ABCC_LOG_ANSI_COLOR_RESET,
+   ".."ABCC_LOG_ANSI_COLOR_MAGENTA"|DEBUG| "ABCC_LOG_ANSI_COLOR_RESET,
+   ""ABCC_LOG_ANSI_COLOR_RED    "|UNKNOWN| "ABCC_LOG_ANSI_COLOR_RESET
+};
+
+#if ABCC_CFG_LOG_BINARY_ENABLED
+/*------------------------------------------------------------------------------
+** Maximum length of a single conversion specification when it is rebuilt for
+** printing, including expanded '*' width/precision values.
+**------------------------------------------------------------------------------
+*/
+#define ABCC_LOG_MAX_CONVERSION_LENGTH 32
 
-   if( ( eSeverity < 0 ) || ( eSeverity >= ABCC_LOG_SEVERITY_UNKNOWN ) )
-   {
-      eSeverity = ABCC_LOG_SEVERITY_UNKNOWN;
-   }
+/*------------------------------------------------------------------------------
+** Type of the argument consumed by a conversion specification.
+**------------------------------------------------------------------------------
+*/
+typedef enum
+{
+   ABCC_LOG_ARG_NONE,
+   ABCC_LOG_ARG_INT,
+   ABCC_LOG_ARG_LONG,
+   ABCC_LOG_ARG_LONG_LONG,
+   ABCC_LOG_ARG_INTMAX,
+   ABCC_LOG_ARG_SIZE,
+   ABCC_LOG_ARG_PTRDIFF,
+   ABCC_LOG_ARG_PTR,
+   ABCC_LOG_ARG_DOUBLE,
+   ABCC_LOG_ARG_LONG_DOUBLE
+}
+abcc_LogArgClassType;
 
+/*------------------------------------------------------------------------------
+** Ring buffer of log records.
+**
+** abcc_iLogWrIdx is only updated inside a critical section when a record is
+** reserved. The record is then filled outside the critical section and marked
+** as valid when complete. abcc_iLogRdIdx is only updated by the reader. Both
+** indexes are free running and masked when used to index the ring buffer.
+**------------------------------------------------------------------------------
+*/
+static ABCC_LogRecordType abcc_asLogRecord[ ABCC_CFG_LOG_BINARY_NUM_RECORDS ];
+static volatile BOOL abcc_afLogRecordValid[ ABCC_CFG_LOG_BINARY_NUM_RECORDS ];
+static volatile UINT16 abcc_iLogWrIdx;
+static volatile UINT16 abcc_iLogRdIdx;
+static volatile UINT32 abcc_lLogNumDropped;
+static UINT32 abcc_lLogNumDroppedReported;
+#endif
+
+/*------------------------------------------------------------------------------
+** Prints the timestamp part of a log line.
+**------------------------------------------------------------------------------
+** Arguments:
+**    llTimestamp - Uptime in microseconds if ABCC_PORT_GetMonotonicTimeUs is
+**                  defined, otherwise in milliseconds.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
 #if ABCC_CFG_LOG_TIMESTAMPS_ENABLED
-   UINT64 llUptime = ABCC_GetUptimeMs();
+static void PrintTimestamp( UINT64 llTimestamp )
+{
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+   UINT64 llUptime = llTimestamp / 1000;
+   ABCC_PORT_printf( ABCC_LOG_ANSI_COLOR_GREEN"%02u:%02u:%02u.%06" PRIu32 " - "ABCC_LOG_ANSI_COLOR_RESET,
+      (UINT16)( llUptime / 1000 / 60 / 60 % 24 ),
+      (UINT8)( llUptime / 1000 / 60 % 60 ),
+      (UINT8)( llUptime / 1000 % 60 ),
+      (UINT32)( llTimestamp % 1000000 ) );
+#else
+   UINT64 llUptime = llTimestamp;
    ABCC_PORT_printf( ABCC_LOG_ANSI_COLOR_GREEN"%02u:%02u:%02u.%03u - "ABCC_LOG_ANSI_COLOR_RESET,
       (UINT16)( llUptime / 1000 / 60 / 60 % 24 ),
       (UINT8)( llUptime / 1000 / 60 % 60 ),
       (UINT8)( llUptime / 1000 % 60 ),
       (UINT16)( llUptime % 1000 ) );
 #endif
+}
+
+/*------------------------------------------------------------------------------
+** Returns the current timestamp in the unit expected by PrintTimestamp().
+**------------------------------------------------------------------------------
+*/
+static UINT64 GetTimestamp( void )
+{
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+   return( ABCC_GetUptimeUs() );
+#else
+   return( ABCC_GetUptimeMs() );
+#endif
+}
+#endif
 
+/*------------------------------------------------------------------------------
+** Prints the file and line part of a log line, padded to a fixed width.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pcFilename - File name, a path prefix is stripped.
+**    xLine      - Line number.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
 #if ABCC_CFG_LOG_FILE_LINE_ENABLED
+static void PrintFileLine( const char* pcFilename, int xLine )
+{
    const char* pcPos;
    const char* pcBasename;
    int xLen;
@@ -127,9 +209,626 @@ void ABCC_LogHandler(
    {
       ABCC_PORT_printf( "." );
    }
+}
 #endif
 
-   ABCC_PORT_printf( "%s", apcSeverityToString[ eSeverity ] );
+#if ABCC_CFG_LOG_BINARY_ENABLED && ABCC_CFG_LOG_STRINGS_ENABLED
+/*------------------------------------------------------------------------------
+** Parses one printf style conversion specification.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pcSpec      - Pointer to the '%' starting the specification.
+**    peClass     - Type of the argument consumed by the conversion.
+**                  ABCC_LOG_ARG_NONE for "%%" and malformed specifications.
+**    pbNumStars  - Number of additional int arguments consumed by '*' width
+**                  and precision fields.
+**
+** Returns:
+**    Pointer to the first character after the specification.
+**------------------------------------------------------------------------------
+*/
+static const char* ParseConversion( const char* pcSpec,
+                                    abcc_LogArgClassType* peClass,
+                                    UINT8* pbNumStars )
+{
+   const char* pcPos;
+   abcc_LogArgClassType eIntClass;
+   BOOL fLongDouble;
+
+   pcPos = pcSpec + 1;
+   *pbNumStars = 0;
+   *peClass = ABCC_LOG_ARG_NONE;
+   eIntClass = ABCC_LOG_ARG_INT;
+   fLongDouble = FALSE;
+
+   while( ( *pcPos == '-' ) || ( *pcPos == '+' ) || ( *pcPos == ' ' ) ||
+          ( *pcPos == '#' ) || ( *pcPos == '0' ) )
+   {
+      pcPos++;
+   }
+
+   if( *pcPos == '*' )
+   {
+      (*pbNumStars)++;
+      pcPos++;
+   }
+
+   while( ( *pcPos >= '0' ) && ( *pcPos <= '9' ) )
+   {
+      pcPos++;
+   }
+
+   if( *pcPos == '.' )
+   {
+      pcPos++;
+
+      if( *pcPos == '*' )
+      {
+         (*pbNumStars)++;
+         pcPos++;
+      }
+
+      while( ( *pcPos >= '0' ) && ( *pcPos <= '9' ) )
+      {
+         pcPos++;
+      }
+   }
+
+   switch( *pcPos )
+   {
+   case 'h':
+      pcPos++;
+      if( *pcPos == 'h' )
+      {
+         pcPos++;
+      }
+      break;
+
+   case 'l':
+      pcPos++;
+      eIntClass = ABCC_LOG_ARG_LONG;
+      if( *pcPos == 'l' )
+      {
+         pcPos++;
+         eIntClass = ABCC_LOG_ARG_LONG_LONG;
+      }
+      break;
+
+   case 'j':
+      pcPos++;
+      eIntClass = ABCC_LOG_ARG_INTMAX;
+      break;
+
+   case 'z':
+      pcPos++;
+      eIntClass = ABCC_LOG_ARG_SIZE;
+      break;
+
+   case 't':
+      pcPos++;
+      eIntClass = ABCC_LOG_ARG_PTRDIFF;
+      break;
+
+   case 'L':
+      pcPos++;
+      fLongDouble = TRUE;
+      break;
+
+   default:
+      break;
+   }
+
+   switch( *pcPos )
+   {
+   case 'd':
+   case 'i':
+   case 'o':
+   case 'u':
+   case 'x':
+   case 'X':
+   case 'c':
+      *peClass = eIntClass;
+      break;
+
+   case 'f':
+   case 'F':
+   case 'e':
+   case 'E':
+   case 'g':
+   case 'G':
+   case 'a':
+   case 'A':
+      *peClass = fLongDouble ? ABCC_LOG_ARG_LONG_DOUBLE : ABCC_LOG_ARG_DOUBLE;
+      break;
+
+   case 's':
+   case 'p':
+   case 'n':
+      *peClass = ABCC_LOG_ARG_PTR;
+      break;
+
+   case '\0':
+      *pbNumStars = 0;
+      return( pcPos );
+
+   default:
+      *pbNumStars = 0;
+      break;
+   }
+
+   return( pcPos + 1 );
+}
+
+/*------------------------------------------------------------------------------
+** Fetches the next variadic argument of the given type into a record.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pxArgp  - Variadic argument list.
+**    eClass  - Type of the argument.
+**    puArg   - Where to store the argument.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void StoreArg( va_list* pxArgp, abcc_LogArgClassType eClass, ABCC_LogArgType* puArg )
+{
+   switch( eClass )
+   {
+   case ABCC_LOG_ARG_LONG:
+      puArg->lLong = va_arg( *pxArgp, unsigned long );
+      break;
+
+   case ABCC_LOG_ARG_LONG_LONG:
+      puArg->llLong = (UINT64)va_arg( *pxArgp, unsigned long long );
+      break;
+
+   case ABCC_LOG_ARG_INTMAX:
+      puArg->llLong = (UINT64)va_arg( *pxArgp, uintmax_t );
+      break;
+
+   case ABCC_LOG_ARG_SIZE:
+      puArg->llLong = (UINT64)va_arg( *pxArgp, size_t );
+      break;
+
+   case ABCC_LOG_ARG_PTRDIFF:
+      puArg->llLong = (UINT64)va_arg( *pxArgp, ptrdiff_t );
+      break;
+
+   case ABCC_LOG_ARG_PTR:
+      puArg->pxPtr = va_arg( *pxArgp, const void* );
+      break;
+
+   case ABCC_LOG_ARG_DOUBLE:
+      puArg->dDouble = va_arg( *pxArgp, double );
+      break;
+
+   case ABCC_LOG_ARG_LONG_DOUBLE:
+      puArg->dDouble = (double)va_arg( *pxArgp, long double );
+      break;
+
+   default:
+      puArg->xInt = va_arg( *pxArgp, unsigned int );
+      break;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Rebuilds a conversion specification with '*' replaced by the stored width
+** and precision values and any 'L' length modifier removed, since long double
+** arguments are stored as double.
+**------------------------------------------------------------------------------
+** Arguments:
+**    pcSpec     - Start of the conversion specification.
+**    pcSpecEnd  - First character after the conversion specification.
+**    pauStars   - Stored '*' arguments.
+**    pcDest     - Destination buffer of ABCC_LOG_MAX_CONVERSION_LENGTH.
+**
+** Returns:
+**    TRUE if the specification fit in the destination buffer.
+**------------------------------------------------------------------------------
+*/
+static BOOL BuildConversion( const char* pcSpec,
+                             const char* pcSpecEnd,
+                             const ABCC_LogArgType* pauStars,
+                             char* pcDest )
+{
+   char acDigits[ 12 ];
+   UINT16 iLen;
+   UINT8 bNumDigits;
+   long lValue;
+
+   iLen = 0;
+
+   while( pcSpec < pcSpecEnd )
+   {
+      if( *pcSpec == '*' )
+      {
+         lValue = (long)(int)pauStars->xInt;
+         pauStars++;
+
+         if( lValue < 0 )
+         {
+            if( iLen >= ( ABCC_LOG_MAX_CONVERSION_LENGTH - 1 ) )
+            {
+               return( FALSE );
+            }
+            pcDest[ iLen++ ] = '-';
+            lValue = -lValue;
+         }
+
+         bNumDigits = 0;
+         do
+         {
+            acDigits[ bNumDigits++ ] = (char)( '0' + ( lValue % 10 ) );
+            lValue /= 10;
+         }
+         while( lValue > 0 );
+
+         if( ( iLen + bNumDigits ) >= ABCC_LOG_MAX_CONVERSION_LENGTH )
+         {
+            return( FALSE );
+         }
+
+         while( bNumDigits > 0 )
+         {
+            pcDest[ iLen++ ] = acDigits[ --bNumDigits ];
+         }
+      }
+      else if( *pcSpec != 'L' )
+      {
+         if( iLen >= ( ABCC_LOG_MAX_CONVERSION_LENGTH - 1 ) )
+         {
+            return( FALSE );
+         }
+         pcDest[ iLen++ ] = *pcSpec;
+      }
+
+      pcSpec++;
+   }
+
+   pcDest[ iLen ] = '\0';
+
+   return( TRUE );
+}
+
+/*------------------------------------------------------------------------------
+** Prints the format string of a record using the stored arguments.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psRecord - Record to print.
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void PrintFormat( const ABCC_LogRecordType* psRecord )
+{
+   char acSpec[ ABCC_LOG_MAX_CONVERSION_LENGTH ];
+   const char* pcPos;
+   const char* pcLiteral;
+   const char* pcSpecEnd;
+   const ABCC_LogArgType* puArg;
+   abcc_LogArgClassType eClass;
+   UINT8 bNumStars;
+   UINT8 bArg;
+
+   pcPos = psRecord->pcFormat;
+   pcLiteral = pcPos;
+   bArg = 0;
+
+   while( *pcPos != '\0' )
+   {
+      if( *pcPos != '%' )
+      {
+         pcPos++;
+         continue;
+      }
+
+      if( pcPos > pcLiteral )
+      {
+         ABCC_PORT_printf( "%.*s", (int)( pcPos - pcLiteral ), pcLiteral );
+      }
+
+      pcSpecEnd = ParseConversion( pcPos, &eClass, &bNumStars );
+
+      if( eClass == ABCC_LOG_ARG_NONE )
+      {
+         if( pcPos[ 1 ] == '%' )
+         {
+            ABCC_PORT_printf( "%%" );
+         }
+         else
+         {
+            ABCC_PORT_printf( "%.*s", (int)( pcSpecEnd - pcPos ), pcPos );
+         }
+      }
+      else if( ( ( bArg + bNumStars + 1 ) > psRecord->bNumArgs ) ||
+               ( *( pcSpecEnd - 1 ) == 'n' ) ||
+               !BuildConversion( pcPos, pcSpecEnd, &psRecord->auArgs[ bArg ], acSpec ) )
+      {
+         /*
+         ** Argument not stored, %n or too long specification. Print it as is.
+         */
+         ABCC_PORT_printf( "%.*s", (int)( pcSpecEnd - pcPos ), pcPos );
+         bArg = psRecord->bNumArgs;
+      }
+      else
+      {
+         puArg = &psRecord->auArgs[ bArg + bNumStars ];
+         bArg += bNumStars + 1;
+
+         switch( eClass )
+         {
+         case ABCC_LOG_ARG_LONG:
+            ABCC_PORT_printf( acSpec, puArg->lLong );
+            break;
+
+         case ABCC_LOG_ARG_LONG_LONG:
+            ABCC_PORT_printf( acSpec, (unsigned long long)puArg->llLong );
+            break;
+
+         case ABCC_LOG_ARG_INTMAX:
+            ABCC_PORT_printf( acSpec, (uintmax_t)puArg->llLong );
+            break;
+
+         case ABCC_LOG_ARG_SIZE:
+            ABCC_PORT_printf( acSpec, (size_t)puArg->llLong );
+            break;
+
+         case ABCC_LOG_ARG_PTRDIFF:
+            ABCC_PORT_printf( acSpec, (ptrdiff_t)puArg->llLong );
+            break;
+
+         case ABCC_LOG_ARG_PTR:
+            ABCC_PORT_printf( acSpec, puArg->pxPtr );
+            break;
+
+         case ABCC_LOG_ARG_DOUBLE:
+         case ABCC_LOG_ARG_LONG_DOUBLE:
+            ABCC_PORT_printf( acSpec, puArg->dDouble );
+            break;
+
+         default:
+            ABCC_PORT_printf( acSpec, puArg->xInt );
+            break;
+         }
+      }
+
+      pcPos = pcSpecEnd;
+      pcLiteral = pcPos;
+   }
+
+   if( pcPos > pcLiteral )
+   {
+      ABCC_PORT_printf( "%.*s", (int)( pcPos - pcLiteral ), pcLiteral );
+   }
+}
+#endif
+
+#if ABCC_CFG_LOG_BINARY_ENABLED
+void ABCC_LogHandler(
+   ABCC_LogSeverityType eSeverity,
+   ABCC_ErrorCodeType eErrorCode,
+   UINT32 lAdditionalInfo
+#if ABCC_CFG_LOG_FILE_LINE_ENABLED
+   , const char *pcFilename,
+   int xLine
+#endif
+#if ABCC_CFG_LOG_STRINGS_ENABLED
+   , const char* pcFormat,
+   ...
+#endif
+)
+{
+   ABCC_LogRecordType* psRecord;
+   UINT16 iIndex;
+#if ABCC_CFG_LOG_STRINGS_ENABLED
+   const char* pcPos;
+   abcc_LogArgClassType eClass;
+   UINT8 bNumStars;
+   va_list argp;
+#endif
+   ABCC_PORT_UseCritical();
+
+   if( ( eSeverity < 0 ) || ( eSeverity >= ABCC_LOG_SEVERITY_UNKNOWN ) )
+   {
+      eSeverity = ABCC_LOG_SEVERITY_UNKNOWN;
+   }
+
+   /*
+   ** Only the reservation of a record is protected. The record is filled in
+   ** outside the critical section and published by setting the valid flag.
+   */
+   ABCC_PORT_EnterCritical();
+   if( (UINT16)( abcc_iLogWrIdx - abcc_iLogRdIdx ) >= ABCC_CFG_LOG_BINARY_NUM_RECORDS )
+   {
+      abcc_lLogNumDropped++;
+      psRecord = NULL;
+      iIndex = 0;
+   }
+   else
+   {
+      iIndex = abcc_iLogWrIdx & ( ABCC_CFG_LOG_BINARY_NUM_RECORDS - 1 );
+      abcc_iLogWrIdx++;
+      psRecord = &abcc_asLogRecord[ iIndex ];
+   }
+   ABCC_PORT_ExitCritical();
+
+   if( psRecord != NULL )
+   {
+      psRecord->bSeverity = (UINT8)eSeverity;
+      psRecord->eErrorCode = eErrorCode;
+      psRecord->lAdditionalInfo = lAdditionalInfo;
+#if ABCC_CFG_LOG_TIMESTAMPS_ENABLED
+      psRecord->llTimestamp = GetTimestamp();
+#endif
+#if ABCC_CFG_LOG_FILE_LINE_ENABLED
+      psRecord->pcFilename = pcFilename;
+      psRecord->xLine = xLine;
+#endif
+#if ABCC_CFG_LOG_STRINGS_ENABLED
+      psRecord->pcFormat = pcFormat;
+      psRecord->bNumArgs = 0;
+
+      va_start( argp, pcFormat );
+      for( pcPos = pcFormat; *pcPos != '\0'; )
+      {
+         if( *pcPos != '%' )
+         {
+            pcPos++;
+            continue;
+         }
+
+         pcPos = ParseConversion( pcPos, &eClass, &bNumStars );
+
+         if( eClass == ABCC_LOG_ARG_NONE )
+         {
+            continue;
+         }
+
+         if( ( psRecord->bNumArgs + bNumStars + 1 ) > ABCC_CFG_LOG_BINARY_MAX_ARGS )
+         {
+            break;
+         }
+
+         while( bNumStars > 0 )
+         {
+            StoreArg( &argp, ABCC_LOG_ARG_INT, &psRecord->auArgs[ psRecord->bNumArgs++ ] );
+            bNumStars--;
+         }
+
+         StoreArg( &argp, eClass, &psRecord->auArgs[ psRecord->bNumArgs++ ] );
+      }
+      va_end( argp );
+#endif
+
+      ABCC_PORT_MemoryBarrier();
+      abcc_afLogRecordValid[ iIndex ] = TRUE;
+   }
+
+   if( eSeverity <= ABCC_LOG_SEVERITY_ERROR )
+   {
+      ABCC_LogError( eSeverity, eErrorCode, lAdditionalInfo );
+   }
+}
+
+BOOL ABCC_LogReadRecord( ABCC_LogRecordType* psRecord )
+{
+   UINT16 iIndex;
+
+   iIndex = abcc_iLogRdIdx & ( ABCC_CFG_LOG_BINARY_NUM_RECORDS - 1 );
+
+   if( !abcc_afLogRecordValid[ iIndex ] )
+   {
+      return( FALSE );
+   }
+
+   /*
+   ** The record must not be read before the valid flag, and the slot must not
+   ** be released before the record has been copied.
+   */
+   ABCC_PORT_MemoryBarrier();
+   *psRecord = abcc_asLogRecord[ iIndex ];
+   ABCC_PORT_MemoryBarrier();
+   abcc_afLogRecordValid[ iIndex ] = FALSE;
+   abcc_iLogRdIdx++;
+
+   return( TRUE );
+}
+
+UINT32 ABCC_LogGetNumDropped( void )
+{
+   return( abcc_lLogNumDropped );
+}
+
+void ABCC_LogPrintRecord( const ABCC_LogRecordType* psRecord )
+{
+   UINT8 bSeverity;
+
+   bSeverity = psRecord->bSeverity;
+   if( bSeverity >= ABCC_LOG_SEVERITY_UNKNOWN )
+   {
+      bSeverity = ABCC_LOG_SEVERITY_UNKNOWN;
+   }
+
+#if ABCC_CFG_LOG_TIMESTAMPS_ENABLED
+   PrintTimestamp( psRecord->llTimestamp );
+#endif
+#if ABCC_CFG_LOG_FILE_LINE_ENABLED
+   PrintFileLine( psRecord->pcFilename, psRecord->xLine );
+#endif
+
+   ABCC_PORT_printf( "%s", abcc_apcSeverityToString[ bSeverity ] );
+
+#if ABCC_CFG_LOG_STRINGS_ENABLED
+   PrintFormat( psRecord );
+#else
+   if( bSeverity <= ABCC_LOG_SEVERITY_WARNING )
+   {
+      ABCC_PORT_printf( "Error code: %d, Additional info: %" PRIu32 "\n", psRecord->eErrorCode, psRecord->lAdditionalInfo );
+   }
+   else
+   {
+      ABCC_PORT_printf( "\n" );
+   }
+#endif
+}
+
+UINT16 ABCC_LogFlush( UINT16 iMaxRecords )
+{
+   ABCC_LogRecordType sRecord;
+   UINT32 lNumDropped;
+   UINT16 iNumPrinted;
+
+   lNumDropped = abcc_lLogNumDropped;
+   if( lNumDropped != abcc_lLogNumDroppedReported )
+   {
+      ABCC_PORT_printf( "%s%" PRIu32 " log records dropped\n",
+                        abcc_apcSeverityToString[ ABCC_LOG_SEVERITY_WARNING ],
+                        (UINT32)( lNumDropped - abcc_lLogNumDroppedReported ) );
+      abcc_lLogNumDroppedReported = lNumDropped;
+   }
+
+   iNumPrinted = 0;
+   while( ( ( iMaxRecords == 0 ) || ( iNumPrinted < iMaxRecords ) ) &&
+          ABCC_LogReadRecord( &sRecord ) )
+   {
+      ABCC_LogPrintRecord( &sRecord );
+      iNumPrinted++;
+   }
+
+   return( iNumPrinted );
+}
+#else
+void ABCC_LogHandler(
+   ABCC_LogSeverityType eSeverity,
+   ABCC_ErrorCodeType eErrorCode,
+   UINT32 lAdditionalInfo
+#if ABCC_CFG_LOG_FILE_LINE_ENABLED
+   , const char *pcFilename,
+   int xLine
+#endif
+#if ABCC_CFG_LOG_STRINGS_ENABLED
+   , const char* pcFormat,
+   ...
+#endif
+)
+{
+   if( ( eSeverity < 0 ) || ( eSeverity >= ABCC_LOG_SEVERITY_UNKNOWN ) )
+   {
+      eSeverity = ABCC_LOG_SEVERITY_UNKNOWN;
+   }
+
+#if ABCC_CFG_LOG_TIMESTAMPS_ENABLED
+   PrintTimestamp( GetTimestamp() );
+#endif
+
+#if ABCC_CFG_LOG_FILE_LINE_ENABLED
+   PrintFileLine( pcFilename, xLine );
+#endif
+
+   ABCC_PORT_printf( "%s", abcc_apcSeverityToString[ eSeverity ] );
 
 #if ABCC_CFG_LOG_STRINGS_ENABLED
    va_list argp;
@@ -152,6 +851,7 @@ void ABCC_LogHandler(
       ABCC_LogError( eSeverity, eErrorCode, lAdditionalInfo );
    }
 }
+#endif
 
 void ABCC_LogError( ABCC_LogSeverityType eSeverity, ABCC_ErrorCodeType eErrorCode, UINT32 lAdditionalInfo )
 {
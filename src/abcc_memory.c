@@ -7,6 +7,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_MEMORY
+
 #include "abcc_config.h"
 #include "abcc_types.h"
 #include "abcc.h"
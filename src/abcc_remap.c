@@ -17,26 +17,34 @@
 #include "abcc_handler.h"
 #include "abcc_link.h"
 
-static UINT16   abcc_iNewPdReadSize    = 0;
-static UINT16   abcc_iNewPdWriteSize   = 0;
-
 static void abcc_RemapRespMsgSent( void )
 {
-   ABCC_SetPdSize( abcc_iNewPdReadSize, abcc_iNewPdWriteSize );
+   /*
+   ** The driver has already switched to the new process data sizes on the
+   ** frame boundary where the response was sent.
+   */
    ABCC_CbfRemapDone();
 }
 
 ABCC_ErrorCodeType ABCC_SendRemapRespMsg( ABP_MsgType* psMsgResp, UINT16 iNewReadPdSize, const UINT16 iNewWritePdSize )
 {
    ABCC_ErrorCodeType eResult;
-   abcc_iNewPdReadSize = iNewReadPdSize;
-   abcc_iNewPdWriteSize = iNewWritePdSize;
+
+   /*
+   ** Let the driver prepare the new layout before the response can be sent.
+   */
+   ABCC_PrepareRemap( psMsgResp, iNewReadPdSize, iNewWritePdSize );
 
    /*
    ** When ack is sent abcc_RemapRespMsgSent will be called.
    */
    eResult = ABCC_LinkWrMsgWithNotification( psMsgResp, abcc_RemapRespMsgSent );
 
+   if( eResult != ABCC_EC_NO_ERROR )
+   {
+      ABCC_PrepareRemap( NULL, 0, 0 );
+   }
+
    return( eResult );
 }
 
@@ -7,6 +7,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_SEGMENTATION
+
 #include "abcc_config.h"
 #include "abcc_types.h"
 #include "abp.h"
@@ -15,10 +17,25 @@
 #include "abcc_port.h"
 #include "abcc_segmentation.h"
 
+/*
+** ABCC_NUM_SEGMENTATION_SESSIONS is kept for backward compatibility with
+** configurations defining it directly.
+*/
 #ifndef ABCC_NUM_SEGMENTATION_SESSIONS
-#define ABCC_NUM_SEGMENTATION_SESSIONS 1
+#define ABCC_NUM_SEGMENTATION_SESSIONS ABCC_CFG_MAX_NUM_SEG_SESSIONS
 #endif
 
+/*
+** Number of hash buckets used to look up sessions, must be a power of two.
+*/
+#define ABCC_SEG_HASH_SIZE 8
+#define ABCC_SEG_HASH_MASK ( ABCC_SEG_HASH_SIZE - 1 )
+
+/*
+** Index used to terminate the session lists.
+*/
+#define ABCC_SEG_NO_SESSION 0xFF
+
 #define ABCC_MSG_HEADER_TYPE_SIZEOF 12
 
 /*------------------------------------------------------------------------------
@@ -40,30 +57,77 @@ typedef struct abcc_SegSessionIdentifiers
 }
 abcc_SegSessionIdentifiersType;
 
+/*------------------------------------------------------------------------------
+** State of the block following the current block of a data source.
+**------------------------------------------------------------------------------
+*/
+typedef enum abcc_SegNextBlockState
+{
+   ABCC_SEG_NEXT_BLOCK_NONE,     /* Not requested */
+   ABCC_SEG_NEXT_BLOCK_PENDING,  /* Requested, not yet supplied */
+   ABCC_SEG_NEXT_BLOCK_READY,    /* Supplied and waiting to be sent */
+   ABCC_SEG_NEXT_BLOCK_END       /* No more data */
+}
+abcc_SegNextBlockStateType;
+
+/*------------------------------------------------------------------------------
+** Source of the data sent by a segmentation session.
+**------------------------------------------------------------------------------
+**   pxData         - Pointer to current data block.
+**   pxObject       - User defined object. Supplied as parameter in callbacks.
+**   pnNext         - Function to be called to get the next data block.
+**   lBytesLeft     - Number of bytes left to be sent of the current block.
+**   lDataBlockSize - Size of the current data block.
+**   pasIoVec       - Next source region to send.
+**   bNumIoVecLeft  - Number of source regions left to send.
+**   fAsync         - Blocks are requested ahead of time and may be supplied
+**                    later by ABCC_SegmentationBlockReady().
+**   eNextState     - State of the next block.
+**   pxNextData     - Pointer to the next block if ready.
+**   lNextBlockSize - Size of the next block if ready.
+**------------------------------------------------------------------------------
+*/
+typedef struct abcc_SegDataSource
+{
+   const void* pxData;
+   const void* pxObject;
+   ABCC_SegMsgHandlerNextBlockFuncType pnNext;
+   UINT32 lBytesLeft;
+   UINT32 lDataBlockSize;
+   const ABCC_SegIoVecType* pasIoVec;
+   UINT8 bNumIoVecLeft;
+   BOOL  fAsync;
+   abcc_SegNextBlockStateType eNextState;
+   const void* pxNextData;
+   UINT32 lNextBlockSize;
+}
+abcc_SegDataSourceType;
+
 /*------------------------------------------------------------------------------
 ** Segmentations session type
 **------------------------------------------------------------------------------
-**   pxData        - Pointer to abcc message payload
+**   sSource       - Data to be sent.
 **   pnDone        - Function to be called when segmentation session is done
-**   pxObject      - User defined object. Supplied as parameter in pnDone function.
-**   lBytesLeft    - Number of bytes left to be sent.
-**   lTotalMsgSize - Size of entire payload to be sent
+**   psWaitingMsg  - Message buffer of the next segment while waiting for a
+**                   pending block. NULL if not waiting.
+**   fWaitingFirst - The waiting segment is the first segment.
 **   bRspCmdExt0   - Command extension 0 value to use in response segments.
 **   sIdentifiers  - Used to match commands with existing sessions.
 **   fInUse        - Indicates if the session is in use.
+**   bNext         - Index of next session in the same hash bucket, or next
+**                   free session if the session is not in use.
 **------------------------------------------------------------------------------
 */
 typedef struct abcc_SegSession
 {
-   const void* pxData;
-   const void* pxObject;
+   abcc_SegDataSourceType sSource;
    ABCC_SegMsgHandlerDoneFuncType pnDone;
-   ABCC_SegMsgHandlerNextBlockFuncType pnNext;
-   UINT32 lBytesLeft;
-   UINT32 lDataBlockSize;
+   ABP_MsgType* psWaitingMsg;
+   BOOL  fWaitingFirst;
    UINT8 bRspCmdExt0;
    abcc_SegSessionIdentifiersType sIdentifiers;
    BOOL  fInUse;
+   UINT8 bNext;
 }
 abcc_SegSessionType;
 
@@ -80,31 +144,167 @@ static UINT8 abcc_bSegNumUsedInst;
 static abcc_SegSessionType abcc_sSegSession[ ABCC_NUM_SEGMENTATION_SESSIONS ];
 
 /*------------------------------------------------------------------------------
-** Allocate segmentations instance
+** Index of the first free session and of the first session in each hash
+** bucket.
+**------------------------------------------------------------------------------
+*/
+static UINT8 abcc_bSegFreeList;
+static UINT8 abcc_abSegHashBucket[ ABCC_SEG_HASH_SIZE ];
+
+/*------------------------------------------------------------------------------
+** Client segmentation session type
+**------------------------------------------------------------------------------
+**   sSource       - Data to be sent.
+**   pnDone        - Function to be called when the session has ended.
+**   bDestObj      - Destination object of the segments.
+**   iInstance     - Instance of the segments.
+**   bCmd          - Command of the segments.
+**   bCmdExt0      - Command extension 0 of the segments.
+**   bMaxInFlight  - Maximum number of segments waiting for a response.
+**   bNumInFlight  - Number of segments waiting for a response.
+**   abSourceId    - Source IDs of the segments waiting for a response, oldest
+**                   first.
+**   fFirstSent    - The first segment has been sent.
+**   fLastSent     - The last segment has been sent.
+**   fAborted      - The session has ended, responses to segments still in
+**                   flight are discarded.
+**   fInUse        - Indicates if the session is in use.
+**------------------------------------------------------------------------------
+*/
+typedef struct abcc_SegClientSession
+{
+   abcc_SegDataSourceType sSource;
+   ABCC_SegClientMsgHandlerDoneFuncType pnDone;
+   UINT8 bDestObj;
+   UINT16 iInstance;
+   UINT8 bCmd;
+   UINT8 bCmdExt0;
+   UINT8 bMaxInFlight;
+   UINT8 bNumInFlight;
+   UINT8 abSourceId[ ABCC_CFG_MAX_NUM_APPL_CMDS ];
+   BOOL  fFirstSent;
+   BOOL  fLastSent;
+   BOOL  fAborted;
+   BOOL  fInUse;
+}
+abcc_SegClientSessionType;
+
+/*------------------------------------------------------------------------------
+** Place holder for client segmentation sessions
+**------------------------------------------------------------------------------
+*/
+static abcc_SegClientSessionType abcc_sSegClientSession[ ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS ];
+
+/*------------------------------------------------------------------------------
+** Reassembly session type
+**------------------------------------------------------------------------------
+**   pxBuffer      - Buffer to store the command data in.
+**   lBufferSize   - Size of pxBuffer.
+**   pxObject      - User defined object. Supplied as parameter in callbacks.
+**   pnSink        - Function to be called with the data of each segment.
+**   pnDone        - Function to be called when the session has ended.
+**   lTotalSize    - Number of octets received so far.
+**   sIdentifiers  - Used to match commands with existing sessions.
+**   fInUse        - Indicates if the session is in use.
+**------------------------------------------------------------------------------
+*/
+typedef struct abcc_SegReassemblySession
+{
+   void* pxBuffer;
+   UINT32 lBufferSize;
+   const void* pxObject;
+   ABCC_SegMsgHandlerSinkFuncType pnSink;
+   ABCC_SegReassemblyDoneFuncType pnDone;
+   UINT32 lTotalSize;
+   abcc_SegSessionIdentifiersType sIdentifiers;
+   BOOL  fInUse;
+}
+abcc_SegReassemblySessionType;
+
+/*------------------------------------------------------------------------------
+** Number of reassembly sessions in use and place holder for the sessions.
+**------------------------------------------------------------------------------
+*/
+static UINT8 abcc_bSegNumReassemblyInst;
+static abcc_SegReassemblySessionType abcc_sSegReassemblySession[ ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS ];
+
+/*------------------------------------------------------------------------------
+** Calculate the hash bucket of a set of session identifiers.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psIdentifiers - Pointer to session identifiers.
+**
+** Returns:
+**    Hash bucket index.
+**------------------------------------------------------------------------------
+*/
+static UINT8 SegSessionHash( const abcc_SegSessionIdentifiersType* psIdentifiers )
+{
+   UINT8 bHash;
+
+   bHash = psIdentifiers->bDestObj;
+   bHash ^= (UINT8)( psIdentifiers->iInstance & 0xFF );
+   bHash ^= (UINT8)( psIdentifiers->iInstance >> 8 );
+   bHash ^= (UINT8)( psIdentifiers->bCmd << 3 );
+   bHash ^= (UINT8)( psIdentifiers->bCmdExt0 << 1 );
+   bHash ^= bHash >> 4;
+
+   return( bHash & ABCC_SEG_HASH_MASK );
+}
+
+/*------------------------------------------------------------------------------
+** Allocate segmentations instance from the free list and insert it in the hash
+** bucket of its identifiers.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    None
+**    psIdentifiers - Identifiers of the command starting the session.
 ** Returns:
 **    Pointer to abcc_SegInstanceType. NULL if no free resource is found
 **------------------------------------------------------------------------------
 */
-static abcc_SegSessionType* AllocSegmentationSession( void )
+static abcc_SegSessionType* AllocSegmentationSession( const abcc_SegSessionIdentifiersType* psIdentifiers )
 {
    UINT8 bSession;
+   UINT8 bHash;
    abcc_SegSessionType* psSegSession = NULL;
    ABCC_PORT_UseCritical();
 
+   bHash = SegSessionHash( psIdentifiers );
+
    ABCC_PORT_EnterCritical();
 
-   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   bSession = abcc_bSegFreeList;
+
+   if( bSession != ABCC_SEG_NO_SESSION )
    {
-      if( !abcc_sSegSession[ bSession ].fInUse )
+      psSegSession = &abcc_sSegSession[ bSession ];
+      abcc_bSegFreeList = psSegSession->bNext;
+
+      psSegSession->sIdentifiers = *psIdentifiers;
+      psSegSession->fInUse = TRUE;
+
+      /*
+      ** Append last in the bucket so that the oldest session with the same
+      ** identifiers is found first.
+      */
+      psSegSession->bNext = ABCC_SEG_NO_SESSION;
+
+      if( abcc_abSegHashBucket[ bHash ] == ABCC_SEG_NO_SESSION )
       {
-         abcc_bSegNumUsedInst++;
-         psSegSession = &abcc_sSegSession[ bSession ];
-         psSegSession->fInUse = TRUE;
-         break;
+         abcc_abSegHashBucket[ bHash ] = bSession;
       }
+      else
+      {
+         UINT8 bLast = abcc_abSegHashBucket[ bHash ];
+
+         while( abcc_sSegSession[ bLast ].bNext != ABCC_SEG_NO_SESSION )
+         {
+            bLast = abcc_sSegSession[ bLast ].bNext;
+         }
+         abcc_sSegSession[ bLast ].bNext = bSession;
+      }
+
+      abcc_bSegNumUsedInst++;
    }
 
    ABCC_PORT_ExitCritical();
@@ -113,7 +313,7 @@ static abcc_SegSessionType* AllocSegmentationSession( void )
 }
 
 /*------------------------------------------------------------------------------
-** Find segmentation session with matching source id.
+** Find segmentation session matching the command.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    psMsg - Pointer to ABCC message.
@@ -125,22 +325,30 @@ static abcc_SegSessionType* AllocSegmentationSession( void )
 static abcc_SegSessionType* FindSegmentationSession( const ABP_MsgType* psMsg )
 {
    UINT8 bSession;
+   abcc_SegSessionIdentifiersType sIdentifiers;
    abcc_SegSessionType* psSegSession = NULL;
    ABCC_PORT_UseCritical();
 
+   sIdentifiers.bDestObj = ABCC_GetMsgDestObj( psMsg );
+   sIdentifiers.iInstance = ABCC_GetMsgInstance( psMsg );
+   sIdentifiers.bCmd = ABCC_GetMsgCmdBits( psMsg );
+   sIdentifiers.bCmdExt0 = ABCC_GetMsgCmdExt0( psMsg );
+
    ABCC_PORT_EnterCritical();
 
-   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   bSession = abcc_abSegHashBucket[ SegSessionHash( &sIdentifiers ) ];
+
+   while( bSession != ABCC_SEG_NO_SESSION )
    {
-      if( abcc_sSegSession[ bSession ].fInUse &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.bDestObj == ABCC_GetMsgDestObj( psMsg ) ) &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.iInstance == ABCC_GetMsgInstance( psMsg ) ) &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.bCmd == ABCC_GetMsgCmdBits( psMsg ) ) &&
-         ( abcc_sSegSession[ bSession ].sIdentifiers.bCmdExt0 == ABCC_GetMsgCmdExt0( psMsg ) ) )
+      if( ( abcc_sSegSession[ bSession ].sIdentifiers.bDestObj == sIdentifiers.bDestObj ) &&
+          ( abcc_sSegSession[ bSession ].sIdentifiers.iInstance == sIdentifiers.iInstance ) &&
+          ( abcc_sSegSession[ bSession ].sIdentifiers.bCmd == sIdentifiers.bCmd ) &&
+          ( abcc_sSegSession[ bSession ].sIdentifiers.bCmdExt0 == sIdentifiers.bCmdExt0 ) )
       {
          psSegSession = &abcc_sSegSession[ bSession ];
          break;
       }
+      bSession = abcc_sSegSession[ bSession ].bNext;
    }
    ABCC_PORT_ExitCritical();
 
@@ -148,7 +356,8 @@ static abcc_SegSessionType* FindSegmentationSession( const ABP_MsgType* psMsg )
 }
 
 /*------------------------------------------------------------------------------
-** Free segmentation session resource
+** Free segmentation session resource. The session is removed from its hash
+** bucket and returned to the free list.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    psSegSession - Pointer to segmentation instance
@@ -159,118 +368,330 @@ static abcc_SegSessionType* FindSegmentationSession( const ABP_MsgType* psMsg )
 */
 static void FreeSegmentationSession( abcc_SegSessionType* psSegSession )
 {
+   UINT8 bSession;
+   UINT8* pbLink;
    ABCC_PORT_UseCritical();
 
+   bSession = (UINT8)( psSegSession - abcc_sSegSession );
+
    ABCC_PORT_EnterCritical();
 
+   pbLink = &abcc_abSegHashBucket[ SegSessionHash( &psSegSession->sIdentifiers ) ];
+
+   while( *pbLink != ABCC_SEG_NO_SESSION )
+   {
+      if( *pbLink == bSession )
+      {
+         *pbLink = psSegSession->bNext;
+         break;
+      }
+      pbLink = &abcc_sSegSession[ *pbLink ].bNext;
+   }
+
    psSegSession->fInUse = FALSE;
+   psSegSession->bNext = abcc_bSegFreeList;
+   abcc_bSegFreeList = bSession;
    abcc_bSegNumUsedInst--;
 
    ABCC_PORT_ExitCritical();
 }
 
 /*------------------------------------------------------------------------------
-** Get next data block from callback if available
+** Initialise a data source.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    psSegSession - Pointer to segmentation instance
+**    psSource  - Pointer to segmentation data source
+**    pxData    - Pointer to first data block
+**    lSize     - Size of first data block
+**    pasIoVec  - Pointer to source regions sent after the first block
+**    bNumIoVec - Number of source regions
+**    pnNext    - Function to be called to get the next data block
+**    fAsync    - Request blocks ahead of time
+**    pxObject  - User defined object
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void InitDataSource( abcc_SegDataSourceType* psSource,
+                            const void* pxData,
+                            UINT32 lSize,
+                            const ABCC_SegIoVecType* pasIoVec,
+                            UINT8 bNumIoVec,
+                            ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                            BOOL fAsync,
+                            const void* pxObject )
+{
+   psSource->pxData = pxData;
+   psSource->lBytesLeft = lSize;
+   psSource->lDataBlockSize = lSize;
+   psSource->pasIoVec = pasIoVec;
+   psSource->bNumIoVecLeft = bNumIoVec;
+   psSource->pnNext = pnNext;
+   psSource->pxObject = pxObject;
+   psSource->fAsync = fAsync;
+   psSource->eNextState = ABCC_SEG_NEXT_BLOCK_NONE;
+}
+
+/*------------------------------------------------------------------------------
+** Request the next data block from the user callback. The result is stored as
+** the next block of the data source.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource - Pointer to segmentation data source
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void RequestNextBlock( abcc_SegDataSourceType* psSource )
+{
+   const void* pxData;
+   UINT32 lSize = 0;
+
+   /*
+   ** Set pending before calling the user, the block may be supplied by
+   ** ABCC_SegmentationBlockReady() from within the callback.
+   */
+   psSource->eNextState = ABCC_SEG_NEXT_BLOCK_PENDING;
+
+   pxData = psSource->pnNext( (void*)psSource->pxObject, &lSize );
+
+   if( pxData != NULL )
+   {
+      psSource->pxNextData = pxData;
+      psSource->lNextBlockSize = lSize;
+      psSource->eNextState = ABCC_SEG_NEXT_BLOCK_READY;
+   }
+   else if( !psSource->fAsync || ( lSize != ABCC_SEG_BLOCK_PENDING ) )
+   {
+      psSource->eNextState = ABCC_SEG_NEXT_BLOCK_END;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Make the next source region or data block the current block, if available.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource - Pointer to segmentation data source
 **
 ** Returns:
 **    None.
 **------------------------------------------------------------------------------
 */
-static void GetNextDataBlock( abcc_SegSessionType* psSegSession )
+static void GetNextDataBlock( abcc_SegDataSourceType* psSource )
 {
-   if( psSegSession->pnNext != NULL )
+   ABCC_PORT_UseCritical();
+
+   psSource->pxData = NULL;
+   psSource->lDataBlockSize = 0;
+
+   while( ( psSource->bNumIoVecLeft > 0 ) && ( psSource->lDataBlockSize == 0 ) )
+   {
+      psSource->pxData = psSource->pasIoVec->pxData;
+      psSource->lDataBlockSize = psSource->pasIoVec->lSize;
+      psSource->pasIoVec++;
+      psSource->bNumIoVecLeft--;
+   }
+
+   if( ( psSource->lDataBlockSize == 0 ) && ( psSource->pnNext != NULL ) )
    {
-      psSegSession->pxData = psSegSession->pnNext( (void*)psSegSession->pxObject,
-                                                   &psSegSession->lDataBlockSize );
+      if( psSource->eNextState == ABCC_SEG_NEXT_BLOCK_NONE )
+      {
+         RequestNextBlock( psSource );
+      }
 
-      if( psSegSession->pxData == NULL )
+      ABCC_PORT_EnterCritical();
+
+      if( psSource->eNextState == ABCC_SEG_NEXT_BLOCK_READY )
       {
-         psSegSession->lDataBlockSize = 0;
+         psSource->pxData = psSource->pxNextData;
+         psSource->lDataBlockSize = psSource->lNextBlockSize;
+         psSource->eNextState = ABCC_SEG_NEXT_BLOCK_NONE;
       }
 
-      psSegSession->lBytesLeft = psSegSession->lDataBlockSize;
+      ABCC_PORT_ExitCritical();
+   }
+
+   if( psSource->pxData == NULL )
+   {
+      psSource->lDataBlockSize = 0;
    }
+
+   psSource->lBytesLeft = psSource->lDataBlockSize;
 }
 
 /*------------------------------------------------------------------------------
-** Copy next segment to the abcc message and set the required segmentation bits.
+** Request the block following the current block ahead of time, if the current
+** block will be completely sent with the next segment. Only done for
+** asynchronous data sources.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    psSegSession - Pointer to segmentation instance
-**    psMsg        - Pointer to abcc message
-**    fFirstSeg    - Indicates first segment
+**    psSource - Pointer to segmentation data source
 **
 ** Returns:
 **    None.
 **------------------------------------------------------------------------------
 */
-static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession, ABP_MsgType* psMsg, BOOL fFirstSeg )
+static void PrefetchNextBlock( abcc_SegDataSourceType* psSource )
+{
+   if( psSource->fAsync &&
+       ( psSource->pnNext != NULL ) &&
+       ( psSource->bNumIoVecLeft == 0 ) &&
+       ( psSource->eNextState == ABCC_SEG_NEXT_BLOCK_NONE ) &&
+       ( psSource->lBytesLeft <= ABCC_GetMaxMessageSize() ) )
+   {
+      RequestNextBlock( psSource );
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Check if the data source is waiting for a block from the user.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource - Pointer to segmentation data source
+**
+** Returns:
+**    TRUE if the current block is sent and the next block is pending.
+**------------------------------------------------------------------------------
+*/
+static BOOL IsBlockPending( const abcc_SegDataSourceType* psSource )
+{
+   return( ( psSource->lBytesLeft == 0 ) &&
+           ( psSource->eNextState == ABCC_SEG_NEXT_BLOCK_PENDING ) );
+}
+
+/*------------------------------------------------------------------------------
+** Copy the next segment of data to the message payload. The payload is filled
+** until the segment is full or until no more data is provided by the user.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSource  - Pointer to segmentation data source
+**    psMsg     - Pointer to abcc message
+**
+** Returns:
+**    Number of octets copied to the message payload.
+**------------------------------------------------------------------------------
+*/
+static UINT16 FillSegment( abcc_SegDataSourceType* psSource, ABP_MsgType* psMsg )
 {
-   UINT8  bCmdExt1 = 0;
    UINT16 iDataSize = 0;
    UINT16 iPayloadOffset;
    UINT16 iNumOctetsToCopy;
 
-   if( fFirstSeg )
+   /*
+   ** If the current block is sent, e.g. no payload pointer was provided or the
+   ** block was pending when the previous segment was sent, check if more data
+   ** is available.
+   */
+   if( psSource->lBytesLeft == 0 )
    {
-      bCmdExt1 = ABP_MSG_CMDEXT1_SEG_FIRST;
-
-      /*
-      ** If no payload pointer is provided, check if the user has implemented the callback
-      */
-      if( psSegSession->pxData == NULL )
-      {
-         GetNextDataBlock( psSegSession );
-      }
+      GetNextDataBlock( psSource );
    }
 
-   /*
-   ** Fill the payload until the segment is full or until no more data is
-   ** provided by the user.
-   */
-   while( ( iDataSize != ABCC_GetMaxMessageSize() ) && ( psSegSession->pxData ) &&
-      ( psSegSession->lBytesLeft != 0 ) )
+   while( ( iDataSize != ABCC_GetMaxMessageSize() ) && ( psSource->pxData ) &&
+      ( psSource->lBytesLeft != 0 ) )
    {
       /*
       ** Store current payload offset
       */
       iPayloadOffset = iDataSize;
 
-      if( ( iDataSize + psSegSession->lBytesLeft ) > ABCC_GetMaxMessageSize() )
+      if( ( iDataSize + psSource->lBytesLeft ) > ABCC_GetMaxMessageSize() )
       {
          iDataSize = ABCC_GetMaxMessageSize();
       }
       else
       {
-         iDataSize += (UINT16)psSegSession->lBytesLeft;
+         iDataSize += (UINT16)psSource->lBytesLeft;
       }
 
       iNumOctetsToCopy = iDataSize - iPayloadOffset;
 
       /*
-      ** Copy payload from user buffer to response message buffer
+      ** Copy payload from user buffer to message buffer
       */
       ABCC_PORT_CopyOctets( ABCC_GetMsgDataPtr( psMsg ),
                             iPayloadOffset,
-                            psSegSession->pxData,
-                            psSegSession->lDataBlockSize - psSegSession->lBytesLeft,
+                            psSource->pxData,
+                            psSource->lDataBlockSize - psSource->lBytesLeft,
                             iNumOctetsToCopy );
 
-      psSegSession->lBytesLeft -= iNumOctetsToCopy;
+      psSource->lBytesLeft -= iNumOctetsToCopy;
 
       /*
       ** If the whole block is copied, check if the user has more data to send.
       */
-      if( psSegSession->lBytesLeft == 0 )
+      if( psSource->lBytesLeft == 0 )
       {
-         GetNextDataBlock( psSegSession );
+         GetNextDataBlock( psSource );
       }
    }
 
-   if( psSegSession->lBytesLeft == 0 )
+   return( iDataSize );
+}
+
+/*------------------------------------------------------------------------------
+** Copy next segment to the abcc message and set the required segmentation bits.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSegSession - Pointer to segmentation instance
+**    psMsg        - Pointer to abcc message
+**    fFirstSeg    - Indicates first segment
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession, ABP_MsgType* psMsg, BOOL fFirstSeg )
+{
+   UINT8  bCmdExt1 = 0;
+   UINT16 iDataSize;
+   BOOL   fLastSeg;
+   ABCC_PORT_UseCritical();
+
+   if( fFirstSeg )
+   {
+      bCmdExt1 = ABP_MSG_CMDEXT1_SEG_FIRST;
+   }
+
+   iDataSize = FillSegment( &psSegSession->sSource, psMsg );
+
+   while( ( iDataSize == 0 ) && IsBlockPending( &psSegSession->sSource ) )
+   {
+      /*
+      ** Nothing to send until the user supplies the pending block. Keep the
+      ** message buffer for the segment, it is sent by
+      ** ABCC_SegmentationBlockReady().
+      */
+      ABCC_TakeMsgBufferOwnership( psMsg );
+
+      ABCC_PORT_EnterCritical();
+
+      if( psSegSession->sSource.eNextState == ABCC_SEG_NEXT_BLOCK_PENDING )
+      {
+         psSegSession->psWaitingMsg = psMsg;
+         psSegSession->fWaitingFirst = fFirstSeg;
+         psMsg = NULL;
+      }
+
+      ABCC_PORT_ExitCritical();
+
+      if( psMsg == NULL )
+      {
+         return;
+      }
+
+      /*
+      ** The block was supplied meanwhile.
+      */
+      iDataSize = FillSegment( &psSegSession->sSource, psMsg );
+   }
+
+   fLastSeg = ( psSegSession->sSource.lBytesLeft == 0 ) &&
+              !IsBlockPending( &psSegSession->sSource );
+
+   if( fLastSeg )
    {
       bCmdExt1 |= ABP_MSG_CMDEXT1_SEG_LAST;
    }
@@ -291,44 +712,506 @@ static void PrepareAndSendSegmentationRespMsg( abcc_SegSessionType* psSegSession
    /*
    ** Check if last segment has been sent
    */
-   if( psSegSession->lBytesLeft == 0 )
+   if( fLastSeg )
    {
       if( psSegSession->pnDone )
       {
-         psSegSession->pnDone( (void*)psSegSession->pxObject );
+         psSegSession->pnDone( (void*)psSegSession->sSource.pxObject );
       }
       FreeSegmentationSession( psSegSession );
    }
+   else
+   {
+      PrefetchNextBlock( &psSegSession->sSource );
+   }
 }
 
-void ABCC_SegmentationInit( void )
+/*------------------------------------------------------------------------------
+** Free client segmentation session resource
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to client segmentation session
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void FreeClientSegmentationSession( abcc_SegClientSessionType* psSession )
 {
-   UINT8 bSession;
+   ABCC_PORT_UseCritical();
 
-   abcc_bSegNumUsedInst = 0;
-   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
-   {
-      abcc_sSegSession[ bSession ].fInUse = FALSE;
-   }
+   ABCC_PORT_EnterCritical();
+
+   psSession->fInUse = FALSE;
+
+   ABCC_PORT_ExitCritical();
 }
 
-EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_MsgHeaderType* psReqMsgHeader,
-                                                                    UINT8 bRspCmdExt0,
-                                                                    const void* pxData,
-                                                                    UINT32 lSize,
-                                                                    ABCC_SegMsgHandlerNextBlockFuncType pnNext,
-                                                                    ABCC_SegMsgHandlerDoneFuncType pnDone,
-                                                                    const void* pxObject )
+/*------------------------------------------------------------------------------
+** End a client segmentation session and report the result to the user. The
+** session resource is kept until all segments in flight have been responded
+** to.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to client segmentation session
+**    psRespMsg - Response to report to the user, NULL if none.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void EndClientSegmentationSession( abcc_SegClientSessionType* psSession,
+                                          ABP_MsgType* psRespMsg )
 {
-   ABP_MsgType* psMsg;
-   abcc_SegSessionType* psSegSession;
+   psSession->fAborted = TRUE;
 
-   if( ( pxData == NULL ) && ( pnNext == NULL ) )
+   if( psSession->pnDone )
    {
-      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+      psSession->pnDone( (void*)psSession->sSource.pxObject, psRespMsg );
+   }
+
+   if( psSession->bNumInFlight == 0 )
+   {
+      FreeClientSegmentationSession( psSession );
+   }
+}
+
+static void HandleClientSegmentResp( ABP_MsgType* psMsg );
+
+/*------------------------------------------------------------------------------
+** Send segments of a client segmentation session until the last segment has
+** been sent or the maximum number of segments are in flight. Sending stops
+** early if the command queue is full or no message buffer is available, the
+** session then continues when the next segment response is received. If a
+** segment could not be sent the session is marked as aborted, it is up to the
+** caller to end it.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to client segmentation session
+**    psMsg     - Message buffer to use for the first segment sent, e.g. a
+**                received response. NULL to allocate a new buffer.
+**
+** Returns:
+**    Number of segments sent.
+**------------------------------------------------------------------------------
+*/
+static UINT8 SendClientSegments( abcc_SegClientSessionType* psSession, ABP_MsgType* psMsg )
+{
+   UINT8 bCmdExt1;
+   UINT8 bSourceId;
+   UINT8 bNumSent = 0;
+   UINT16 iDataSize;
+   ABCC_ErrorCodeType eResult;
+
+   while( !psSession->fLastSent &&
+          ( psSession->bNumInFlight < psSession->bMaxInFlight ) )
+   {
+      /*
+      ** The command queue is shared with the application and the command
+      ** sequencer. FillSegment() consumes the source data, so check for a free
+      ** entry before filling a segment that then could not be sent.
+      */
+      if( ABCC_GetCmdQueueSize() == 0 )
+      {
+         break;
+      }
+
+      if( psMsg == NULL )
+      {
+         psMsg = ABCC_GetCmdMsgBuffer();
+
+         if( psMsg == NULL )
+         {
+            break;
+         }
+      }
+
+      bCmdExt1 = 0;
+      if( !psSession->fFirstSent )
+      {
+         bCmdExt1 = ABP_MSG_CMDEXT1_SEG_FIRST;
+      }
+
+      iDataSize = FillSegment( &psSession->sSource, psMsg );
+      psSession->fFirstSent = TRUE;
+
+      if( psSession->sSource.lBytesLeft == 0 )
+      {
+         bCmdExt1 |= ABP_MSG_CMDEXT1_SEG_LAST;
+         psSession->fLastSent = TRUE;
+      }
+
+      bSourceId = ABCC_GetNewSourceId();
+
+      ABCC_SetMsgSourceId( psMsg, bSourceId );
+      ABCC_SetMsgDestObj( psMsg, psSession->bDestObj );
+      ABCC_SetMsgInstance( psMsg, psSession->iInstance );
+      ABCC_SetMsgCmdField( psMsg, psSession->bCmd | ABP_MSG_HEADER_C_BIT );
+      ABCC_SetMsgCmdExt0( psMsg, psSession->bCmdExt0 );
+      ABCC_SetMsgCmdExt1( psMsg, bCmdExt1 );
+      ABCC_SetMsgDataSize( psMsg, iDataSize );
+
+      psSession->abSourceId[ psSession->bNumInFlight++ ] = bSourceId;
+
+      eResult = ABCC_SendCmdMsg( psMsg, HandleClientSegmentResp );
+
+      if( eResult != ABCC_EC_NO_ERROR )
+      {
+         /*
+         ** The link layer frees the buffer if the command queue is full, on
+         ** any other error the buffer is still owned by this session.
+         */
+         if( eResult != ABCC_EC_LINK_CMD_QUEUE_FULL )
+         {
+            ABCC_ReturnMsgBuffer( &psMsg );
+         }
+
+         ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES,
+            bSourceId,
+            "Failed to send segment, client segmentation session aborted\n" );
+
+         psSession->bNumInFlight--;
+         psSession->fAborted = TRUE;
+         break;
+      }
+
+      psMsg = NULL;
+      bNumSent++;
+   }
+
+   return( bNumSent );
+}
+
+/*------------------------------------------------------------------------------
+** Response handler for segments sent by client segmentation sessions.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg - Pointer to response message
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void HandleClientSegmentResp( ABP_MsgType* psMsg )
+{
+   UINT8 bSession;
+   UINT8 bIndex;
+   UINT8 bSourceId;
+   abcc_SegClientSessionType* psSession = NULL;
+
+   bSourceId = ABCC_GetMsgSourceId( psMsg );
+
+   for( bSession = 0; bSession < ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS; bSession++ )
+   {
+      if( abcc_sSegClientSession[ bSession ].fInUse )
+      {
+         for( bIndex = 0; bIndex < abcc_sSegClientSession[ bSession ].bNumInFlight; bIndex++ )
+         {
+            if( abcc_sSegClientSession[ bSession ].abSourceId[ bIndex ] == bSourceId )
+            {
+               psSession = &abcc_sSegClientSession[ bSession ];
+               break;
+            }
+         }
+      }
+
+      if( psSession != NULL )
+      {
+         break;
+      }
+   }
+
+   if( psSession == NULL )
+   {
+      return;
+   }
+
+   /*
+   ** Remove the segment from the in flight list.
+   */
+   psSession->bNumInFlight--;
+   for( ; bIndex < psSession->bNumInFlight; bIndex++ )
+   {
+      psSession->abSourceId[ bIndex ] = psSession->abSourceId[ bIndex + 1 ];
+   }
+
+   if( psSession->fAborted )
+   {
+      if( psSession->bNumInFlight == 0 )
+      {
+         FreeClientSegmentationSession( psSession );
+      }
+   }
+   else if( ABCC_GetMsgCmdField( psMsg ) & ABP_MSG_HEADER_E_BIT )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_ERROR_RESP_SEGMENTATION,
+         bSourceId,
+         "Client segmentation session ended by error response (source ID: %" PRIu8 ")\n",
+         bSourceId );
+
+      EndClientSegmentationSession( psSession, psMsg );
+   }
+   else if( psSession->fLastSent )
+   {
+      if( psSession->bNumInFlight == 0 )
+      {
+         EndClientSegmentationSession( psSession, psMsg );
+      }
+   }
+   else
+   {
+      /*
+      ** Reuse the response buffer for the next segment.
+      */
+      (void)SendClientSegments( psSession, psMsg );
+
+      if( !psSession->fAborted && ( psSession->bNumInFlight == 0 ) )
+      {
+         /*
+         ** Nothing could be sent and no response is left to continue the
+         ** session.
+         */
+         ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES,
+            bSourceId,
+            "No command queue entry or message buffer available, client segmentation session aborted\n" );
+
+         psSession->fAborted = TRUE;
+      }
+
+      if( psSession->fAborted )
+      {
+         EndClientSegmentationSession( psSession, NULL );
+      }
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Find reassembly session matching the command.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg - Pointer to ABCC message.
+**
+** Returns:
+**    Pointer to reassembly session. NULL if no match is found.
+**------------------------------------------------------------------------------
+*/
+static abcc_SegReassemblySessionType* FindReassemblySession( const ABP_MsgType* psMsg )
+{
+   UINT8 bSession;
+   abcc_SegReassemblySessionType* psSession;
+
+   for( bSession = 0; bSession < ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS; bSession++ )
+   {
+      psSession = &abcc_sSegReassemblySession[ bSession ];
+
+      if( psSession->fInUse &&
+          ( psSession->sIdentifiers.bDestObj == ABCC_GetMsgDestObj( psMsg ) ) &&
+          ( psSession->sIdentifiers.iInstance == ABCC_GetMsgInstance( psMsg ) ) &&
+          ( psSession->sIdentifiers.bCmd == ABCC_GetMsgCmdBits( psMsg ) ) &&
+          ( psSession->sIdentifiers.bCmdExt0 == ABCC_GetMsgCmdExt0( psMsg ) ) )
+      {
+         return( psSession );
+      }
+   }
+
+   return( NULL );
+}
+
+/*------------------------------------------------------------------------------
+** End a reassembly session. The session is freed before pnDone is called so
+** that a new session can be started from the callback.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to reassembly session.
+**    psMsg     - Last segment to pass to the user, NULL if the session was
+**                aborted.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void EndReassemblySession( abcc_SegReassemblySessionType* psSession, ABP_MsgType* psMsg )
+{
+   ABCC_SegReassemblyDoneFuncType pnDone = psSession->pnDone;
+   const void* pxObject = psSession->pxObject;
+   UINT32 lTotalSize = psSession->lTotalSize;
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+
+   psSession->fInUse = FALSE;
+   abcc_bSegNumReassemblyInst--;
+
+   ABCC_PORT_ExitCritical();
+
+   if( pnDone )
+   {
+      pnDone( (void*)pxObject, psMsg, lTotalSize );
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Handle a received segment of a reassembly session. The segment data is
+** delivered to the user and the segment is responded to, except the last
+** segment which is passed to the user.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psSession - Pointer to reassembly session.
+**    psMsg     - Pointer to received segment.
+**
+** Returns:
+**    None.
+**------------------------------------------------------------------------------
+*/
+static void HandleReassemblySegment( abcc_SegReassemblySessionType* psSession, ABP_MsgType* psMsg )
+{
+   UINT8 bCmdExt1;
+   UINT16 iSize;
+   ABP_MsgErrorCodeType eErr = ABP_ERR_NO_ERROR;
+
+   bCmdExt1 = ABCC_GetMsgCmdExt1( psMsg );
+
+   if( bCmdExt1 & ABP_MSG_CMDEXT1_SEG_ABORT )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_ERROR_RESP_SEGMENTATION,
+            ABCC_GetMsgSourceId( psMsg ),
+            "Segmented command aborted by ABCC (source ID: %" PRIu8 ")\n",
+            ABCC_GetMsgSourceId( psMsg ) );
+
+      ABP_SetMsgResponse( psMsg, 0 );
+      ABCC_SendRespMsg( psMsg );
+      EndReassemblySession( psSession, NULL );
+      return;
+   }
+
+   iSize = ABCC_GetMsgDataSize( psMsg );
+
+   if( psSession->pnSink != NULL )
+   {
+      eErr = psSession->pnSink( (void*)psSession->pxObject,
+                                ABCC_GetMsgDataPtr( psMsg ),
+                                iSize,
+                                psSession->lTotalSize );
+   }
+   else if( ( psSession->lTotalSize + iSize ) > psSession->lBufferSize )
+   {
+      eErr = ABP_ERR_NO_RESOURCES;
+   }
+   else
+   {
+      /*
+      ** The octet offsets of ABCC_PORT_CopyOctets() are 16 bit, advance the
+      ** destination pointer instead since the buffer may be larger than that.
+      */
+#ifdef ABCC_SYS_16_BIT_CHAR
+      ABCC_PORT_CopyOctets( (UINT16*)psSession->pxBuffer + ( psSession->lTotalSize >> 1 ),
+                            (UINT16)( psSession->lTotalSize & 1 ),
+                            ABCC_GetMsgDataPtr( psMsg ),
+                            0,
+                            iSize );
+#else
+      ABCC_PORT_CopyOctets( (UINT8*)psSession->pxBuffer + psSession->lTotalSize,
+                            0,
+                            ABCC_GetMsgDataPtr( psMsg ),
+                            0,
+                            iSize );
+#endif
+   }
+
+   if( eErr != ABP_ERR_NO_ERROR )
+   {
+      ABP_SetMsgErrorResponse( psMsg, 1, eErr );
+      ABCC_SendRespMsg( psMsg );
+      EndReassemblySession( psSession, NULL );
+      return;
+   }
+
+   psSession->lTotalSize += iSize;
+
+   if( bCmdExt1 & ABP_MSG_CMDEXT1_SEG_LAST )
+   {
+      EndReassemblySession( psSession, psMsg );
+      return;
+   }
+
+   /*
+   ** Acknowledge the segment with an empty response.
+   */
+   ABP_SetMsgResponse( psMsg, 0 );
+   ABCC_SendRespMsg( psMsg );
+}
+
+void ABCC_SegmentationInit( void )
+{
+   UINT8 bSession;
+   UINT8 bHash;
+
+   abcc_bSegNumUsedInst = 0;
+   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   {
+      abcc_sSegSession[ bSession ].fInUse = FALSE;
+      abcc_sSegSession[ bSession ].bNext = bSession + 1;
+   }
+   abcc_sSegSession[ ABCC_NUM_SEGMENTATION_SESSIONS - 1 ].bNext = ABCC_SEG_NO_SESSION;
+   abcc_bSegFreeList = 0;
+
+   for( bHash = 0; bHash < ABCC_SEG_HASH_SIZE; bHash++ )
+   {
+      abcc_abSegHashBucket[ bHash ] = ABCC_SEG_NO_SESSION;
+   }
+
+   for( bSession = 0; bSession < ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS; bSession++ )
+   {
+      abcc_sSegClientSession[ bSession ].fInUse = FALSE;
+   }
+
+   abcc_bSegNumReassemblyInst = 0;
+   for( bSession = 0; bSession < ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS; bSession++ )
+   {
+      abcc_sSegReassemblySession[ bSession ].fInUse = FALSE;
    }
+}
+
+/*------------------------------------------------------------------------------
+** Start a server response segmentation session and send the first segment.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psReqMsgHeader - Pointer to request message header.
+**    bRspCmdExt0    - Value of command extension 0 to use in response segments.
+**    pxData         - Pointer to first message payload block.
+**    lSize          - Size of first payload block.
+**    pasIoVec       - Pointer to source regions sent after the first block.
+**    bNumIoVec      - Number of source regions.
+**    pnNext         - Callback to request the next data block.
+**    pnDone         - Callback to indicate that the entire message is sent.
+**    fAsync         - Request blocks ahead of time.
+**    pxObject       - User defined object.
+**
+** Returns:
+**    ABCC_ErrorCodeType
+**------------------------------------------------------------------------------
+*/
+static ABCC_ErrorCodeType StartServerRespSegmentationSession( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                              UINT8 bRspCmdExt0,
+                                                              const void* pxData,
+                                                              UINT32 lSize,
+                                                              const ABCC_SegIoVecType* pasIoVec,
+                                                              UINT8 bNumIoVec,
+                                                              ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                              ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                              BOOL fAsync,
+                                                              const void* pxObject )
+{
+   ABP_MsgType* psMsg;
+   abcc_SegSessionType* psSegSession;
+   abcc_SegSessionIdentifiersType sIdentifiers;
+
+   sIdentifiers.bDestObj = ABCC_GetMsgDestObj( psReqMsgHeader );
+   sIdentifiers.iInstance = ABCC_GetMsgInstance( psReqMsgHeader );
+   sIdentifiers.bCmd = ABCC_GetMsgCmdBits( psReqMsgHeader );
+   sIdentifiers.bCmdExt0 = ABCC_GetMsgCmdExt0( psReqMsgHeader );
 
-   psSegSession = AllocSegmentationSession();
+   psSegSession = AllocSegmentationSession( &sIdentifiers );
 
    if( psSegSession == NULL )
    {
@@ -337,17 +1220,17 @@ EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_Ms
       return( ABCC_EC_NO_RESOURCES );
    }
 
-   psSegSession->lBytesLeft = lSize;
-   psSegSession->lDataBlockSize = lSize;
-   psSegSession->pxData = pxData;
+   InitDataSource( &psSegSession->sSource,
+                   pxData,
+                   lSize,
+                   pasIoVec,
+                   bNumIoVec,
+                   pnNext,
+                   fAsync,
+                   pxObject );
    psSegSession->pnDone = pnDone;
-   psSegSession->pnNext = pnNext;
-   psSegSession->pxObject = pxObject;
+   psSegSession->psWaitingMsg = NULL;
    psSegSession->bRspCmdExt0 = bRspCmdExt0;
-   psSegSession->sIdentifiers.bDestObj = ABCC_GetMsgDestObj( psReqMsgHeader );
-   psSegSession->sIdentifiers.iInstance = ABCC_GetMsgInstance( psReqMsgHeader );
-   psSegSession->sIdentifiers.bCmd = ABCC_GetMsgCmdBits( psReqMsgHeader );
-   psSegSession->sIdentifiers.bCmdExt0 = ABCC_GetMsgCmdExt0( psReqMsgHeader );
 
    /*
    ** Get message buffer. Will be converted to response later.
@@ -375,9 +1258,132 @@ EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_Ms
    return( ABCC_EC_NO_ERROR );
 }
 
+EXTFUNC ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSession( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                    UINT8 bRspCmdExt0,
+                                                                    const void* pxData,
+                                                                    UINT32 lSize,
+                                                                    ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                                    ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                    const void* pxObject )
+{
+   if( ( pxData == NULL ) && ( pnNext == NULL ) )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   return( StartServerRespSegmentationSession( psReqMsgHeader,
+                                               bRspCmdExt0,
+                                               pxData,
+                                               lSize,
+                                               NULL,
+                                               0,
+                                               pnNext,
+                                               pnDone,
+                                               FALSE,
+                                               pxObject ) );
+}
+
+ABCC_ErrorCodeType ABCC_StartServerRespSegmentationSessionIoVec( const ABP_MsgHeaderType* psReqMsgHeader,
+                                                                 UINT8 bRspCmdExt0,
+                                                                 const ABCC_SegIoVecType* pasIoVec,
+                                                                 UINT8 bNumIoVec,
+                                                                 ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                                 ABCC_SegMsgHandlerDoneFuncType pnDone,
+                                                                 const void* pxObject )
+{
+   if( ( ( pasIoVec == NULL ) || ( bNumIoVec == 0 ) ) && ( pnNext == NULL ) )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   return( StartServerRespSegmentationSession( psReqMsgHeader,
+                                               bRspCmdExt0,
+                                               NULL,
+                                               0,
+                                               pasIoVec,
+                                               bNumIoVec,
+                                               pnNext,
+                                               pnDone,
+                                               TRUE,
+                                               pxObject ) );
+}
+
+ABCC_ErrorCodeType ABCC_SegmentationBlockReady( const void* pxObject,
+                                                const void* pxData,
+                                                UINT32 lSize )
+{
+   UINT8 bSession;
+   abcc_SegSessionType* psSegSession = NULL;
+   ABP_MsgType* psMsg = NULL;
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+
+   for( bSession = 0; bSession < ABCC_NUM_SEGMENTATION_SESSIONS; bSession++ )
+   {
+      if( abcc_sSegSession[ bSession ].fInUse &&
+          ( abcc_sSegSession[ bSession ].sSource.pxObject == pxObject ) &&
+          ( abcc_sSegSession[ bSession ].sSource.eNextState == ABCC_SEG_NEXT_BLOCK_PENDING ) )
+      {
+         psSegSession = &abcc_sSegSession[ bSession ];
+
+         if( pxData != NULL )
+         {
+            psSegSession->sSource.pxNextData = pxData;
+            psSegSession->sSource.lNextBlockSize = lSize;
+            psSegSession->sSource.eNextState = ABCC_SEG_NEXT_BLOCK_READY;
+         }
+         else
+         {
+            psSegSession->sSource.eNextState = ABCC_SEG_NEXT_BLOCK_END;
+         }
+
+         psMsg = psSegSession->psWaitingMsg;
+         psSegSession->psWaitingMsg = NULL;
+         break;
+      }
+   }
+
+   ABCC_PORT_ExitCritical();
+
+   if( psSegSession == NULL )
+   {
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+
+   if( psMsg != NULL )
+   {
+      PrepareAndSendSegmentationRespMsg( psSegSession, psMsg, psSegSession->fWaitingFirst );
+   }
+
+   return( ABCC_EC_NO_ERROR );
+}
+
 BOOL ABCC_HandleSegmentAck( ABP_MsgType* psMsg )
 {
    abcc_SegSessionType* psSegSession;
+   abcc_SegReassemblySessionType* psReassemblySession;
+
+   if( abcc_bSegNumReassemblyInst != 0 )
+   {
+      psReassemblySession = FindReassemblySession( psMsg );
+
+      if( psReassemblySession != NULL )
+      {
+         if( ABCC_GetMsgCmdExt1( psMsg ) & ABP_MSG_CMDEXT1_SEG_FIRST )
+         {
+            /*
+            ** A new segmented command replaces the ongoing one. The new
+            ** command is passed on to the application.
+            */
+            EndReassemblySession( psReassemblySession, NULL );
+            return( FALSE );
+         }
+
+         HandleReassemblySegment( psReassemblySession, psMsg );
+         return( TRUE );
+      }
+   }
 
    if( abcc_bSegNumUsedInst == 0 )
    {
@@ -400,11 +1406,160 @@ BOOL ABCC_HandleSegmentAck( ABP_MsgType* psMsg )
       /*
       ** Abort segmentation by clearing number of bytes left and clear callback pointer
       */
-      psSegSession->lBytesLeft = 0;
-      psSegSession->pnNext = NULL;
+      psSegSession->sSource.lBytesLeft = 0;
+      psSegSession->sSource.bNumIoVecLeft = 0;
+      psSegSession->sSource.pnNext = NULL;
+      psSegSession->sSource.eNextState = ABCC_SEG_NEXT_BLOCK_END;
    }
 
    PrepareAndSendSegmentationRespMsg( psSegSession, psMsg, FALSE );
 
    return( TRUE );
 }
+
+ABCC_ErrorCodeType ABCC_StartClientCmdSegmentationSession( const ABP_MsgHeaderType* psCmdMsgHeader,
+                                                           const void* pxData,
+                                                           UINT32 lSize,
+                                                           ABCC_SegMsgHandlerNextBlockFuncType pnNext,
+                                                           ABCC_SegClientMsgHandlerDoneFuncType pnDone,
+                                                           UINT8 bMaxSegmentsInFlight,
+                                                           const void* pxObject )
+{
+   UINT8 bSession;
+   abcc_SegClientSessionType* psSession = NULL;
+   ABCC_PORT_UseCritical();
+
+   if( ( pxData == NULL ) && ( pnNext == NULL ) )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   ABCC_PORT_EnterCritical();
+
+   for( bSession = 0; bSession < ABCC_CFG_MAX_NUM_CLIENT_SEG_SESSIONS; bSession++ )
+   {
+      if( !abcc_sSegClientSession[ bSession ].fInUse )
+      {
+         psSession = &abcc_sSegClientSession[ bSession ];
+         psSession->fInUse = TRUE;
+         break;
+      }
+   }
+
+   ABCC_PORT_ExitCritical();
+
+   if( psSession == NULL )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES, 0, "No client segmentation session resources available\n" );
+
+      return( ABCC_EC_NO_RESOURCES );
+   }
+
+   if( bMaxSegmentsInFlight == 0 )
+   {
+      bMaxSegmentsInFlight = 1;
+   }
+   else if( bMaxSegmentsInFlight > ABCC_CFG_MAX_NUM_APPL_CMDS )
+   {
+      bMaxSegmentsInFlight = ABCC_CFG_MAX_NUM_APPL_CMDS;
+   }
+
+   InitDataSource( &psSession->sSource,
+                   pxData,
+                   lSize,
+                   NULL,
+                   0,
+                   pnNext,
+                   FALSE,
+                   pxObject );
+   psSession->pnDone = pnDone;
+   psSession->bDestObj = ABCC_GetMsgDestObj( psCmdMsgHeader );
+   psSession->iInstance = ABCC_GetMsgInstance( psCmdMsgHeader );
+   psSession->bCmd = ABCC_GetMsgCmdBits( psCmdMsgHeader );
+   psSession->bCmdExt0 = ABCC_GetMsgCmdExt0( psCmdMsgHeader );
+   psSession->bMaxInFlight = bMaxSegmentsInFlight;
+   psSession->bNumInFlight = 0;
+   psSession->fFirstSent = FALSE;
+   psSession->fLastSent = FALSE;
+   psSession->fAborted = FALSE;
+
+   if( SendClientSegments( psSession, NULL ) == 0 )
+   {
+      /*
+      ** Nothing sent, the user is informed by the return value only.
+      */
+      FreeClientSegmentationSession( psSession );
+
+      ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES,
+         0,
+         "No command queue entry or message buffer available for client segmentation session\n" );
+
+      return( ABCC_EC_NO_RESOURCES );
+   }
+
+   if( psSession->fAborted )
+   {
+      EndClientSegmentationSession( psSession, NULL );
+   }
+
+   return( ABCC_EC_NO_ERROR );
+}
+
+ABCC_ErrorCodeType ABCC_StartServerCmdReassemblySession( ABP_MsgType* psMsg,
+                                                         void* pxBuffer,
+                                                         UINT32 lBufferSize,
+                                                         ABCC_SegMsgHandlerSinkFuncType pnSink,
+                                                         ABCC_SegReassemblyDoneFuncType pnDone,
+                                                         const void* pxObject )
+{
+   UINT8 bSession;
+   abcc_SegReassemblySessionType* psSession = NULL;
+   ABCC_PORT_UseCritical();
+
+   if( ( pxBuffer == NULL ) && ( pnSink == NULL ) )
+   {
+      return( ABCC_EC_UNEXPECTED_NULL_PTR );
+   }
+
+   if( !( ABCC_GetMsgCmdExt1( psMsg ) & ABP_MSG_CMDEXT1_SEG_FIRST ) )
+   {
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+
+   ABCC_PORT_EnterCritical();
+
+   for( bSession = 0; bSession < ABCC_CFG_MAX_NUM_REASSEMBLY_SESSIONS; bSession++ )
+   {
+      if( !abcc_sSegReassemblySession[ bSession ].fInUse )
+      {
+         psSession = &abcc_sSegReassemblySession[ bSession ];
+         psSession->fInUse = TRUE;
+         abcc_bSegNumReassemblyInst++;
+         break;
+      }
+   }
+
+   ABCC_PORT_ExitCritical();
+
+   if( psSession == NULL )
+   {
+      ABCC_LOG_WARNING( ABCC_EC_NO_RESOURCES, 0, "No reassembly session resources available\n" );
+
+      return( ABCC_EC_NO_RESOURCES );
+   }
+
+   psSession->pxBuffer = pxBuffer;
+   psSession->lBufferSize = lBufferSize;
+   psSession->pnSink = pnSink;
+   psSession->pnDone = pnDone;
+   psSession->pxObject = pxObject;
+   psSession->lTotalSize = 0;
+   psSession->sIdentifiers.bDestObj = ABCC_GetMsgDestObj( psMsg );
+   psSession->sIdentifiers.iInstance = ABCC_GetMsgInstance( psMsg );
+   psSession->sIdentifiers.bCmd = ABCC_GetMsgCmdBits( psMsg );
+   psSession->sIdentifiers.bCmdExt0 = ABCC_GetMsgCmdExt0( psMsg );
+
+   HandleReassemblySegment( psSession, psMsg );
+
+   return( ABCC_EC_NO_ERROR );
+}
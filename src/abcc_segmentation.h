@@ -30,7 +30,8 @@ EXTFUNC void ABCC_SegmentationInit( void );
 ** Checks if a received command message is related to an ongoing segmentation
 ** session. If that is the case the response is handled by this function.
 ** Note that the segmentation session is started by the user by calling
-** ABCC_StartServerRespSegmentationSession() declared in abcc.h.
+** ABCC_StartServerRespSegmentationSession() or
+** ABCC_StartServerCmdReassemblySession() declared in abcc.h.
 **------------------------------------------------------------------------------
 ** Arguments:
 **       psMsg - Pointer to abcc command message
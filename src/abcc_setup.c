@@ -7,6 +7,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_SETUP
+
 #include "abcc_config.h"
 #include "abcc_types.h"
 #include "abp.h"
@@ -16,10 +18,41 @@
 #include "abcc_driver_interface.h"
 #include "abcc_log.h"
 
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
+/*
+** Multiplier used to hash ADI instance numbers into the ADI index.
+*/
+#define ABCC_ADI_INDEX_HASH_MULT       ( 40503UL )
+#endif
+
+#if ABCC_CFG_STRUCT_DATA_TYPE_ENABLED && ( ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE > 0 )
+#define ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED 1
+
+/*
+** Marks an ADI without a bit offset table.
+*/
+#define ABCC_STRUCT_NO_TABLE           ( 0xFFFF )
+#else
+#define ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED 0
+#endif
+
 /*
-** Invalid ADI index.
+** Method used by ABCC_GetAdiIndex().
+** ADI_INDEX_NONE     - No ADI table.
+** ADI_INDEX_DENSE    - abcc_aiAdiIndex indexed by instance - abcc_iAdiIndexBase.
+** ADI_INDEX_HASH     - abcc_aiAdiIndex is a hash table with linear probing.
+** ADI_INDEX_SORTED   - Binary search of the ADI table.
+** ADI_INDEX_UNSORTED - Linear search of the ADI table.
 */
-#define AD_INVALID_ADI_INDEX           ( 0xffff )
+typedef enum abcc_AdiIndexMode
+{
+   ADI_INDEX_NONE,
+   ADI_INDEX_DENSE,
+   ADI_INDEX_HASH,
+   ADI_INDEX_SORTED,
+   ADI_INDEX_UNSORTED
+}
+abcc_AdiIndexModeType;
 
 #if !ABCC_CFG_DRV_CMD_SEQ_ENABLED
 typedef enum CmdSetupState
@@ -86,12 +119,17 @@ static const ABCC_CmdSeqType SetupSeqBeforeUserInit[] =
    ABCC_CMD_SEQ( ClearFatalLogCmd,   NULL ),
 #endif
 #endif
-   ABCC_CMD_SEQ( DataFormatCmd,      DataFormatResp ),
-   ABCC_CMD_SEQ( ParamSupportCmd,    ParamSupportResp ),
-   ABCC_CMD_SEQ( ModuleTypeCmd,      ModuleTypeResp ),
-   ABCC_CMD_SEQ( NetworkTypeCmd,     NetworkTypeResp ),
-   ABCC_CMD_SEQ( FirmwareVersionCmd, FirmwareVersionResp ),
-   ABCC_CMD_SEQ( PreparePdMapping,   NULL ),
+   /*
+   ** The discovery requests are independent of each other and are sent
+   ** without waiting for the previous responses. PreparePdMapping waits until
+   ** all of them have been received.
+   */
+   ABCC_CMD_SEQ(             DataFormatCmd,      DataFormatResp ),
+   ABCC_CMD_SEQ_INDEPENDENT( ParamSupportCmd,    ParamSupportResp ),
+   ABCC_CMD_SEQ_INDEPENDENT( ModuleTypeCmd,      ModuleTypeResp ),
+   ABCC_CMD_SEQ_INDEPENDENT( NetworkTypeCmd,     NetworkTypeResp ),
+   ABCC_CMD_SEQ_INDEPENDENT( FirmwareVersionCmd, FirmwareVersionResp ),
+   ABCC_CMD_SEQ(             PreparePdMapping,   NULL ),
    ABCC_CMD_SEQ( ReadWriteMapCmd,    ReadWriteMapResp ),
    ABCC_CMD_SEQ_END()
 };
@@ -150,6 +188,26 @@ static AD_MapType*          abcc_psDefaultMap  = NULL;
 static UINT16               abcc_iNumAdi       = 0;
 static UINT16               abcc_iMappingIndex = 0;
 
+/*
+** ADI instance index, built when ABCC_CbfAdiMappingReq() returns.
+*/
+static abcc_AdiIndexModeType abcc_eAdiIndexMode = ADI_INDEX_NONE;
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
+static UINT16               abcc_aiAdiIndex[ ABCC_CFG_ADI_INDEX_SIZE ];
+static UINT16               abcc_iAdiIndexBase = 0;
+#endif
+
+#if ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED
+/*
+** Bit offset tables of structured ADIs, built when ABCC_CbfAdiMappingReq()
+** returns. Slot 0 to abcc_iNumAdi - 1 hold the position of the table of each
+** ADI, ABCC_STRUCT_NO_TABLE if it has none. The table of an ADI holds the bit
+** offset of each element followed by the total size of the ADI.
+*/
+static UINT16               abcc_aiStructBitOffset[ ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE ];
+static BOOL                 abcc_fStructBitOffsetValid = FALSE;
+#endif
+
 /*
 ** Currently used process data sizes
 */
@@ -203,24 +261,194 @@ static UINT8 bSetupSubState = 0;
 static const ABCC_CmdSeqType* pasSetupSeq;
 #endif
 
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
 /*------------------------------------------------------------------------------
-** Find ADI entry table index for the specified instance number.
+** Get the hash table slot of an ADI instance.
 **------------------------------------------------------------------------------
 ** Arguments:
-**    iInstance         -  Instance number.
+**    iInstance - Instance number.
 **
 ** Returns:
-**    AD_INVALID_ADI_INDEX      - Instance was not found.
+**    Slot in abcc_aiAdiIndex.
 **------------------------------------------------------------------------------
 */
-static UINT16 GetAdiIndex( UINT16 iInstance )
+static UINT16 abcc_AdiIndexHash( UINT16 iInstance )
+{
+   return( (UINT16)( ( (UINT32)iInstance * ABCC_ADI_INDEX_HASH_MULT ) % ABCC_CFG_ADI_INDEX_SIZE ) );
+}
+#endif
+
+/*------------------------------------------------------------------------------
+** Build the ADI instance index for the ADI table returned by
+** ABCC_CbfAdiMappingReq() and check that each instance is defined only once.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void abcc_BuildAdiIndex( void )
+{
+   UINT16 i;
+   UINT16 iMin;
+   UINT16 iMax;
+   BOOL   fSorted;
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
+   UINT16 iSlot;
+   BOOL   fDense;
+#endif
+
+   abcc_eAdiIndexMode = ADI_INDEX_NONE;
+
+   if( ( abcc_psAdiEntry == NULL ) || ( abcc_iNumAdi == 0 ) )
+   {
+      return;
+   }
+
+   fSorted = TRUE;
+   iMin = abcc_psAdiEntry[ 0 ].iInstance;
+   iMax = iMin;
+
+   for( i = 1; i < abcc_iNumAdi; i++ )
+   {
+      if( abcc_psAdiEntry[ i ].iInstance <= abcc_psAdiEntry[ i - 1 ].iInstance )
+      {
+         fSorted = FALSE;
+      }
+
+      if( abcc_psAdiEntry[ i ].iInstance < iMin )
+      {
+         iMin = abcc_psAdiEntry[ i ].iInstance;
+      }
+
+      if( abcc_psAdiEntry[ i ].iInstance > iMax )
+      {
+         iMax = abcc_psAdiEntry[ i ].iInstance;
+      }
+   }
+
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
+   fDense = ( (UINT32)( iMax - iMin ) < ABCC_CFG_ADI_INDEX_SIZE );
+
+   if( fDense || ( abcc_iNumAdi < ABCC_CFG_ADI_INDEX_SIZE ) )
+   {
+      for( iSlot = 0; iSlot < ABCC_CFG_ADI_INDEX_SIZE; iSlot++ )
+      {
+         abcc_aiAdiIndex[ iSlot ] = AD_INVALID_ADI_INDEX;
+      }
+
+      abcc_iAdiIndexBase = iMin;
+
+      for( i = 0; i < abcc_iNumAdi; i++ )
+      {
+         if( fDense )
+         {
+            iSlot = abcc_psAdiEntry[ i ].iInstance - iMin;
+         }
+         else
+         {
+            iSlot = abcc_AdiIndexHash( abcc_psAdiEntry[ i ].iInstance );
+
+            while( ( abcc_aiAdiIndex[ iSlot ] != AD_INVALID_ADI_INDEX ) &&
+                   ( abcc_psAdiEntry[ abcc_aiAdiIndex[ iSlot ] ].iInstance != abcc_psAdiEntry[ i ].iInstance ) )
+            {
+               iSlot++;
+               if( iSlot == ABCC_CFG_ADI_INDEX_SIZE )
+               {
+                  iSlot = 0;
+               }
+            }
+         }
+
+         /*
+         ** The first definition of an instance is used.
+         */
+         if( abcc_aiAdiIndex[ iSlot ] == AD_INVALID_ADI_INDEX )
+         {
+            abcc_aiAdiIndex[ iSlot ] = i;
+         }
+         else
+         {
+            ABCC_LOG_ERROR( ABCC_EC_PARAMETER_NOT_VALID,
+               (UINT32)abcc_psAdiEntry[ i ].iInstance,
+               "ADI instance %" PRIu16 " is defined more than once\n",
+               abcc_psAdiEntry[ i ].iInstance );
+         }
+      }
+
+      abcc_eAdiIndexMode = fDense ? ADI_INDEX_DENSE : ADI_INDEX_HASH;
+      return;
+   }
+#endif
+
+   if( fSorted )
+   {
+      abcc_eAdiIndexMode = ADI_INDEX_SORTED;
+   }
+   else
+   {
+      ABCC_LOG_WARNING( ABCC_EC_PARAMETER_NOT_VALID,
+         0,
+         "ADI table not sorted by instance or instance defined more than once\n" );
+      abcc_eAdiIndexMode = ADI_INDEX_UNSORTED;
+   }
+}
+
+UINT16 ABCC_GetAdiIndex( UINT16 iInstance )
 {
    UINT16   iLow;
    UINT16   iMid;
    UINT16   iHigh;
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
+   UINT16   iSlot;
+#endif
 
-   if( abcc_iNumAdi == 0 )
+   switch( abcc_eAdiIndexMode )
    {
+#if ( ABCC_CFG_ADI_INDEX_SIZE > 0 )
+   case ADI_INDEX_DENSE:
+      iSlot = iInstance - abcc_iAdiIndexBase;
+      if( ( iInstance < abcc_iAdiIndexBase ) ||
+          ( iSlot >= ABCC_CFG_ADI_INDEX_SIZE ) )
+      {
+         return( AD_INVALID_ADI_INDEX );
+      }
+      return( abcc_aiAdiIndex[ iSlot ] );
+
+   case ADI_INDEX_HASH:
+      iSlot = abcc_AdiIndexHash( iInstance );
+      while( abcc_aiAdiIndex[ iSlot ] != AD_INVALID_ADI_INDEX )
+      {
+         if( abcc_psAdiEntry[ abcc_aiAdiIndex[ iSlot ] ].iInstance == iInstance )
+         {
+            return( abcc_aiAdiIndex[ iSlot ] );
+         }
+
+         iSlot++;
+         if( iSlot == ABCC_CFG_ADI_INDEX_SIZE )
+         {
+            iSlot = 0;
+         }
+      }
+      return( AD_INVALID_ADI_INDEX );
+#endif
+
+   case ADI_INDEX_UNSORTED:
+      for( iLow = 0; iLow < abcc_iNumAdi; iLow++ )
+      {
+         if( abcc_psAdiEntry[ iLow ].iInstance == iInstance )
+         {
+            return( iLow );
+         }
+      }
+      return( AD_INVALID_ADI_INDEX );
+
+   case ADI_INDEX_SORTED:
+      break;
+
+   default:
       return( AD_INVALID_ADI_INDEX );
    }
 
@@ -248,40 +476,149 @@ static UINT16 GetAdiIndex( UINT16 iInstance )
    return( iLow );
 }
 
-static UINT16 abcc_GetAdiMapSizeInBits( const AD_AdiEntryType* psAdiEntry, UINT8 bNumElem, UINT8 bElemStartIndex )
+#if ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED
+/*------------------------------------------------------------------------------
+** Build the bit offset tables of the structured ADIs in the ADI table returned
+** by ABCC_CbfAdiMappingReq().
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void abcc_BuildStructBitOffsets( void )
 {
-   UINT16 iSize;
+   UINT16 i;
+   UINT16 iElem;
+   UINT16 iPos;
+   UINT16 iBitOffset;
+   const AD_AdiEntryType* psAdiEntry;
+
+   abcc_fStructBitOffsetValid = FALSE;
+
+   if( ( abcc_psAdiEntry == NULL ) ||
+       ( abcc_iNumAdi > ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE ) )
+   {
+      return;
+   }
+
+   iPos = abcc_iNumAdi;
+
+   for( i = 0; i < abcc_iNumAdi; i++ )
+   {
+      psAdiEntry = &abcc_psAdiEntry[ i ];
+      abcc_aiStructBitOffset[ i ] = ABCC_STRUCT_NO_TABLE;
+
+      if( ( psAdiEntry->psStruct != NULL ) &&
+          ( ( (UINT32)iPos + psAdiEntry->bNumOfElements + 1 ) <= ABCC_CFG_STRUCT_BIT_OFFSET_TABLE_SIZE ) )
+      {
+         abcc_aiStructBitOffset[ i ] = iPos;
+         iBitOffset = 0;
+
+         for( iElem = 0; iElem < psAdiEntry->bNumOfElements; iElem++ )
+         {
+            abcc_aiStructBitOffset[ iPos++ ] = iBitOffset;
+            iBitOffset += ABCC_GetDataTypeSizeInBits( psAdiEntry->psStruct[ iElem ].bDataType );
+         }
+
+         abcc_aiStructBitOffset[ iPos++ ] = iBitOffset;
+      }
+   }
+
+   abcc_fStructBitOffsetValid = TRUE;
+}
+#endif
+
+UINT16 ABCC_GetAdiElementBitOffset( UINT16 iAdiIndex, UINT16 iElemIndex )
+{
+   const AD_AdiEntryType* psAdiEntry;
 #if ABCC_CFG_STRUCT_DATA_TYPE_ENABLED
    UINT16 i;
-   if( psAdiEntry->psStruct == NULL )
+   UINT16 iBitOffset;
+#endif
+
+   if( ( abcc_psAdiEntry == NULL ) || ( iAdiIndex >= abcc_iNumAdi ) )
    {
-      iSize = ABCC_GetDataTypeSizeInBits( psAdiEntry->bDataType ) * bNumElem;
+      return( 0 );
    }
-   else
+
+   psAdiEntry = &abcc_psAdiEntry[ iAdiIndex ];
+
+   if( iElemIndex > psAdiEntry->bNumOfElements )
+   {
+      iElemIndex = psAdiEntry->bNumOfElements;
+   }
+
+#if ABCC_CFG_STRUCT_DATA_TYPE_ENABLED
+   if( psAdiEntry->psStruct != NULL )
    {
-      iSize = 0;
-      for( i = bElemStartIndex; i < ( bNumElem + bElemStartIndex ); i++ )
+#if ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED
+      if( abcc_fStructBitOffsetValid &&
+          ( abcc_aiStructBitOffset[ iAdiIndex ] != ABCC_STRUCT_NO_TABLE ) )
+      {
+         return( abcc_aiStructBitOffset[ abcc_aiStructBitOffset[ iAdiIndex ] + iElemIndex ] );
+      }
+#endif
+
+      iBitOffset = 0;
+      for( i = 0; i < iElemIndex; i++ )
       {
-         iSize += ABCC_GetDataTypeSizeInBits( psAdiEntry->psStruct[ i ].bDataType );
+         iBitOffset += ABCC_GetDataTypeSizeInBits( psAdiEntry->psStruct[ i ].bDataType );
       }
+
+      return( iBitOffset );
    }
-#else
-      (void)bElemStartIndex;
-      iSize = ABCC_GetDataTypeSizeInBits( psAdiEntry->bDataType ) * bNumElem;
 #endif
 
-   return( iSize );
+   return( ABCC_GetDataTypeSizeInBits( psAdiEntry->bDataType ) * iElemIndex );
 }
 
-static void abcc_FillMapExtCommand( ABP_MsgType16* psMsg16, UINT16 iAdi, UINT8 bAdiTotNumElem, UINT8 bElemStartIndex, UINT8 bNumElem, UINT8 bDataType )
+/*------------------------------------------------------------------------------
+** Get the size in bits of a range of elements of an ADI.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iAdiIndex       - Index in the ADI table.
+**    bNumElem        - Number of elements.
+**    bElemStartIndex - Index of the first element.
+**
+** Returns:
+**    Size in bits.
+**------------------------------------------------------------------------------
+*/
+static UINT16 abcc_GetAdiMapSizeInBits( UINT16 iAdiIndex, UINT8 bNumElem, UINT8 bElemStartIndex )
 {
-   psMsg16->aiData[ 0 ] = iTOiLe( iAdi );                               /* ADI Instance number. */
-   ABCC_SetLowAddrOct( psMsg16->aiData[ 1 ], bAdiTotNumElem );          /* Total number of elements in ADI. */
-   ABCC_SetHighAddrOct( psMsg16->aiData[ 1 ], bElemStartIndex );
-   ABCC_SetLowAddrOct( psMsg16->aiData[ 2 ], bNumElem );
-   ABCC_SetHighAddrOct( psMsg16->aiData[ 2 ], 1 );                      /* Number of type descriptors. */
-   ABCC_SetLowAddrOct( psMsg16->aiData[ 3 ], bDataType );               /* ADI element data type. */
-   psMsg16->sHeader.iDataSize = iTOiLe( 7 );                            /* The number of used octets in aiData. (The bytes written below). */
+   return( ABCC_GetAdiElementBitOffset( iAdiIndex, (UINT16)bElemStartIndex + bNumElem ) -
+           ABCC_GetAdiElementBitOffset( iAdiIndex, bElemStartIndex ) );
+}
+
+/*------------------------------------------------------------------------------
+** Add the fixed part of one mapping item to a Map_ADI_Write/Read_Ext_Area
+** command. The caller adds the bNumTypeDesc data type octets after it.
+**------------------------------------------------------------------------------
+** Arguments:
+**    psMsg           - Pointer to the command message.
+**    iOffset         - Octet offset of the item in the message data.
+**    iAdi            - ADI instance number.
+**    bAdiTotNumElem  - Total number of elements in the ADI.
+**    bElemStartIndex - Index of the first element to map.
+**    bNumElem        - Number of elements to map.
+**    bNumTypeDesc    - Number of type descriptors following the item.
+**
+** Returns:
+**    Octet offset of the first type descriptor.
+**------------------------------------------------------------------------------
+*/
+static UINT16 abcc_FillMapExtItem( ABP_MsgType* psMsg, UINT16 iOffset, UINT16 iAdi, UINT8 bAdiTotNumElem, UINT8 bElemStartIndex, UINT8 bNumElem, UINT8 bNumTypeDesc )
+{
+   ABCC_SetMsgData16( psMsg, iAdi, iOffset );                           /* ADI Instance number. */
+   ABCC_SetMsgData8( psMsg, bAdiTotNumElem, iOffset + 2 );              /* Total number of elements in ADI. */
+   ABCC_SetMsgData8( psMsg, bElemStartIndex, iOffset + 3 );
+   ABCC_SetMsgData8( psMsg, bNumElem, iOffset + 4 );
+   ABCC_SetMsgData8( psMsg, bNumTypeDesc, iOffset + 5 );                /* Number of type descriptors. */
+
+   return( iOffset + 6 );
 }
 
 void ABCC_SetupInit( void )
@@ -297,6 +634,10 @@ void ABCC_SetupInit( void )
    abcc_psAdiEntry     = NULL;
    abcc_psDefaultMap   = NULL;
    abcc_iNumAdi = 0;
+   abcc_eAdiIndexMode  = ADI_INDEX_NONE;
+#if ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED
+   abcc_fStructBitOffsetValid = FALSE;
+#endif
    abcc_iMappingIndex  = 0;
    abcc_iPdReadSize    = 0;
    abcc_iPdWriteSize   = 0;
@@ -669,6 +1010,11 @@ static ABCC_CmdSeqCmdStatusType PreparePdMapping( ABP_MsgType* psMsg, void* pxUs
    (void)psMsg;
    abcc_iNumAdi = ABCC_CbfAdiMappingReq( (const AD_AdiEntryType**)&abcc_psAdiEntry,
                                          (const AD_MapType**)&abcc_psDefaultMap );
+   abcc_BuildAdiIndex();
+#if ABCC_STRUCT_BIT_OFFSET_TABLE_ENABLED
+   abcc_BuildStructBitOffsets();
+#endif
+
    /*
    ** No command shall be sent.
    */
@@ -678,6 +1024,9 @@ static ABCC_CmdSeqCmdStatusType PreparePdMapping( ABP_MsgType* psMsg, void* pxUs
 /*------------------------------------------------------------------------------
 ** Read write mapping command
 **
+** Maps as many consecutive default map entries of the same direction as fit
+** in one message.
+**
 ** This function is part of a command sequence. See description of
 ** ABCC_CmdSeqCmdHandler type in abcc_command_sequencer_interface.h
 **------------------------------------------------------------------------------
@@ -703,7 +1052,7 @@ static ABCC_CmdSeqCmdStatusType ReadWriteMapCmd( ABP_MsgType* psMsg, void* pxUse
    {
       if( abcc_psDefaultMap[ abcc_iMappingIndex ].iInstance != AD_MAP_PAD_ADI )
       {
-         iLocalMapIndex = GetAdiIndex( abcc_psDefaultMap[ abcc_iMappingIndex ].iInstance );
+         iLocalMapIndex = ABCC_GetAdiIndex( abcc_psDefaultMap[ abcc_iMappingIndex ].iInstance );
 
          if( iLocalMapIndex == AD_INVALID_ADI_INDEX )
          {
@@ -722,93 +1071,153 @@ static ABCC_CmdSeqCmdStatusType ReadWriteMapCmd( ABP_MsgType* psMsg, void* pxUse
 
    if( ABCC_ReadModuleId() == ABP_MODULE_ID_ACTIVE_ABCC40 )
    {
+      const AD_MapType* psMap;
+      const AD_AdiEntryType* psAdi;
+      PD_DirType eDir;
+      UINT16 iOffset;
+      UINT8 bNumItems;
       UINT8 bNumElemToMap;
       UINT8 bElemMapStartIndex;
+      UINT8 bNumTypeDesc;
 
       /*
       ** Implement mapping according to the extended command for ABCC.
+      ** Consecutive mapping items of the same direction are packed into one
+      ** command as long as they fit in a message.
       */
-      ABCC_SetHighAddrOct( pMsgSendBuffer.psMsg16->sHeader.iSourceIdDestObj, ABP_OBJ_NUM_NW );
-      pMsgSendBuffer.psMsg16->sHeader.iInstance            = iTOiLe( 1 );
+      eDir = abcc_psDefaultMap[ abcc_iMappingIndex ].eDir;
+      iOffset = 0;
+      bNumItems = 0;
 
-      /*
-      ** Number of mapping items to add.
-      */
-      ABCC_SetLowAddrOct( pMsgSendBuffer.psMsg16->sHeader.iCmdExt0CmdExt1, 1 );
-
-      /*
-      ** Reserved
-      */
-      ABCC_SetHighAddrOct( pMsgSendBuffer.psMsg16->sHeader.iCmdExt0CmdExt1, 0 );
-
-      if( abcc_psDefaultMap[ abcc_iMappingIndex ].iInstance != AD_MAP_PAD_ADI )
+      while( ( abcc_psDefaultMap[ abcc_iMappingIndex ].eDir == eDir ) &&
+             ( bNumItems < 0xFF ) )
       {
-         if( abcc_psDefaultMap[ abcc_iMappingIndex ].bNumElem == AD_MAP_ALL_ELEM )
-         {
-            bNumElemToMap = abcc_psAdiEntry[ iLocalMapIndex ].bNumOfElements;
-            bElemMapStartIndex = 0;
-         }
-         else
+         psMap = &abcc_psDefaultMap[ abcc_iMappingIndex ];
+         psAdi = NULL;
+         bNumElemToMap = psMap->bNumElem;
+         bElemMapStartIndex = 0;
+         bNumTypeDesc = 1;
+
+         if( psMap->iInstance != AD_MAP_PAD_ADI )
          {
-            bNumElemToMap = abcc_psDefaultMap[ abcc_iMappingIndex ].bNumElem;
-            bElemMapStartIndex = abcc_psDefaultMap[ abcc_iMappingIndex ].bElemStartIndex;
-         }
+            iLocalMapIndex = ABCC_GetAdiIndex( psMap->iInstance );
+
+            if( iLocalMapIndex == AD_INVALID_ADI_INDEX )
+            {
+               ABCC_LOG_ERROR( ABCC_EC_DEFAULT_MAP_ERR,
+                  (UINT32)psMap->iInstance,
+                  "Error in default map, instance %" PRIu16 " doesn't exist\n",
+                  psMap->iInstance );
+               return( ABCC_CMDSEQ_CMD_ABORT );
+            }
 
-         abcc_FillMapExtCommand( pMsgSendBuffer.psMsg16,
-                                 abcc_psAdiEntry[ iLocalMapIndex ].iInstance,      /* Adi */
-                                 abcc_psAdiEntry[ iLocalMapIndex ].bNumOfElements, /* Adi total num elements */
-                                 bElemMapStartIndex,                               /* Mapping  start index */
-                                 bNumElemToMap,                                    /* Num elements to map */
-                                 abcc_psAdiEntry[ iLocalMapIndex ].bDataType );    /* Data type */
-         iLocalSize = abcc_GetAdiMapSizeInBits( &abcc_psAdiEntry[ iLocalMapIndex ],
-                                                bNumElemToMap, bElemMapStartIndex );
+            psAdi = &abcc_psAdiEntry[ iLocalMapIndex ];
+
+            if( psMap->bNumElem == AD_MAP_ALL_ELEM )
+            {
+               bNumElemToMap = psAdi->bNumOfElements;
+            }
+            else
+            {
+               bElemMapStartIndex = psMap->bElemStartIndex;
+            }
 
 #if ABCC_CFG_STRUCT_DATA_TYPE_ENABLED
-         if( abcc_psAdiEntry[ iLocalMapIndex ].psStruct != NULL )
+            if( psAdi->psStruct != NULL )
+            {
+               bNumTypeDesc = bNumElemToMap;
+            }
+#endif
+         }
+
+         /*
+         ** Each item is 6 octets followed by the type descriptors.
+         */
+         if( ( bNumItems > 0 ) &&
+             ( ( iOffset + 6 + bNumTypeDesc ) > ABCC_GetMaxMessageSize() ) )
          {
-            UINT16 iDescOffset;
-            iDescOffset = 0;
-            ABCC_SetHighAddrOct( pMsgSendBuffer.psMsg16->aiData[ 2 ], bNumElemToMap );
+            break;
+         }
 
-            while( iDescOffset < bNumElemToMap )
+         if( psAdi != NULL )
+         {
+            iOffset = abcc_FillMapExtItem( psMsg,
+                                           iOffset,
+                                           psAdi->iInstance,       /* Adi */
+                                           psAdi->bNumOfElements,  /* Adi total num elements */
+                                           bElemMapStartIndex,     /* Mapping  start index */
+                                           bNumElemToMap,          /* Num elements to map */
+                                           bNumTypeDesc );         /* Num type descriptors */
+#if ABCC_CFG_STRUCT_DATA_TYPE_ENABLED
+            if( psAdi->psStruct != NULL )
             {
-               ABCC_SetLowAddrOct( pMsgSendBuffer.psMsg16->aiData[ ( iDescOffset >> 1 ) + 3 ], abcc_psAdiEntry[ iLocalMapIndex ].psStruct[ iDescOffset + bElemMapStartIndex].bDataType );
-               iDescOffset++;
-               if( iDescOffset < bNumElemToMap )
+               UINT8 bDescIndex;
+
+               for( bDescIndex = 0; bDescIndex < bNumTypeDesc; bDescIndex++ )
                {
-                  ABCC_SetHighAddrOct( pMsgSendBuffer.psMsg16->aiData[ ( iDescOffset >> 1 ) + 3 ], abcc_psAdiEntry[ iLocalMapIndex ].psStruct[ iDescOffset + bElemMapStartIndex].bDataType );
-                  iDescOffset++;
+                  ABCC_SetMsgData8( psMsg, psAdi->psStruct[ bDescIndex + bElemMapStartIndex ].bDataType, iOffset );
+                  iOffset++;
                }
             }
-            pMsgSendBuffer.psMsg16->sHeader.iDataSize = iTOiLe( 6 + iDescOffset );
-         }
+            else
 #endif
-      }
-      else
-      {
-          abcc_FillMapExtCommand( pMsgSendBuffer.psMsg16,
-                                  0,                                                /* Adi */
-                                  abcc_psDefaultMap[ abcc_iMappingIndex ].bNumElem, /* Adi total num elements */
-                                  0,                                                /* Mapping  start index */
-                                  abcc_psDefaultMap[ abcc_iMappingIndex ].bNumElem, /* Num elements to map */
-                                  ABP_PAD1 );                                       /* Data type */
-         iLocalSize = abcc_psDefaultMap[ abcc_iMappingIndex ].bNumElem;
+            {
+               ABCC_SetMsgData8( psMsg, psAdi->bDataType, iOffset );
+               iOffset++;
+            }
+            iLocalSize = abcc_GetAdiMapSizeInBits( iLocalMapIndex, bNumElemToMap, bElemMapStartIndex );
+         }
+         else
+         {
+            iOffset = abcc_FillMapExtItem( psMsg,
+                                           iOffset,
+                                           0,                      /* Adi */
+                                           bNumElemToMap,          /* Adi total num elements */
+                                           0,                      /* Mapping  start index */
+                                           bNumElemToMap,          /* Num elements to map */
+                                           1 );                    /* Num type descriptors */
+            ABCC_SetMsgData8( psMsg, ABP_PAD1, iOffset );
+            iOffset++;
+            iLocalSize = bNumElemToMap;
+         }
+
+         if( eDir == PD_READ )
+         {
+            abcc_iPdReadBitSize += iLocalSize;
+            abcc_iPdReadSize = ( abcc_iPdReadBitSize + 7 ) / 8;
+         }
+         else
+         {
+            abcc_iPdWriteBitSize += iLocalSize;
+            abcc_iPdWriteSize = ( abcc_iPdWriteBitSize + 7 ) / 8;
+         }
 
+         bNumItems++;
+         abcc_iMappingIndex++;
       }
 
-      if( abcc_psDefaultMap[ abcc_iMappingIndex ].eDir == PD_READ )
+      ABCC_SetHighAddrOct( pMsgSendBuffer.psMsg16->sHeader.iSourceIdDestObj, ABP_OBJ_NUM_NW );
+      pMsgSendBuffer.psMsg16->sHeader.iInstance            = iTOiLe( 1 );
+      pMsgSendBuffer.psMsg16->sHeader.iDataSize            = iTOiLe( iOffset );
+
+      /*
+      ** Number of mapping items to add.
+      */
+      ABCC_SetLowAddrOct( pMsgSendBuffer.psMsg16->sHeader.iCmdExt0CmdExt1, bNumItems );
+
+      /*
+      ** Reserved
+      */
+      ABCC_SetHighAddrOct( pMsgSendBuffer.psMsg16->sHeader.iCmdExt0CmdExt1, 0 );
+
+      if( eDir == PD_READ )
       {
          ABCC_SetLowAddrOct( pMsgSendBuffer.psMsg16->sHeader.iCmdReserved, ABP_MSG_HEADER_C_BIT | ABP_NW_CMD_MAP_ADI_READ_EXT_AREA );
-         abcc_iPdReadBitSize += iLocalSize;
-         abcc_iPdReadSize = ( abcc_iPdReadBitSize + 7 ) / 8;
       }
       else
       {
          ABCC_SetLowAddrOct( pMsgSendBuffer.psMsg16->sHeader.iCmdReserved, ABP_MSG_HEADER_C_BIT | ABP_NW_CMD_MAP_ADI_WRITE_EXT_AREA );
-         abcc_iPdWriteBitSize += iLocalSize;
-         abcc_iPdWriteSize = ( abcc_iPdWriteBitSize + 7 ) / 8;
       }
-      abcc_iMappingIndex++;
    }
 
    return( ABCC_CMDSEQ_CMD_SEND );
@@ -880,6 +1289,12 @@ static void TriggerUserInit( const ABCC_CmdSeqResultType eSeqResult, void* pxUse
          "TriggerUserInit reported externally aborted command sequence.\n" );
       break;
 
+   case ABCC_CMDSEQ_RESULT_TIMEOUT:
+      ABCC_LOG_WARNING( ABCC_EC_SETUP_FAILED,
+         (UINT32)eSeqResult,
+         "TriggerUserInit reported timed out command sequence.\n" );
+      break;
+
    default:
       ABCC_LOG_WARNING( ABCC_EC_SETUP_FAILED,
          (UINT32)eSeqResult,
@@ -1084,6 +1499,12 @@ static void SetupDone( const ABCC_CmdSeqResultType eSeqResult, void* pxUserData
          "SetupDone reported externally aborted command sequence. PD mapping can be incomplete.\n" );
       break;
 
+   case ABCC_CMDSEQ_RESULT_TIMEOUT:
+      ABCC_LOG_WARNING( ABCC_EC_SETUP_FAILED,
+         (UINT32)eSeqResult,
+         "SetupDone reported timed out command sequence. PD mapping can be incomplete.\n" );
+      break;
+
    default:
       ABCC_LOG_WARNING( ABCC_EC_SETUP_FAILED,
          (UINT32)eSeqResult,
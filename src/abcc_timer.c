@@ -4,14 +4,32 @@
 ********************************************************************************
 ** File Description:
 ** Timer implementation.
+**
+** Running timers are kept in a timer wheel with one slot per millisecond.
+** Each slot holds a doubly linked list of the timers expiring in that slot
+** (modulo the wheel size), so starting and stopping a timer are O(1) and a
+** timer tick only visits the slots for the elapsed time.
+**
+** ABCC_TimerNextDeadlineMs() walks the wheel from the current slot and stops at
+** the first slot holding a timer due in the current turn, so it never looks at
+** more than one turn of the wheel.
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_TIMER
+
 #include "abcc_timer.h"
 #include "abcc_log.h"
 #include "abcc.h"
 #include "abcc_port.h"
 
+#define TIMER_WHEEL_MASK ( ABCC_CFG_TIMER_WHEEL_SIZE - 1 )
+
+/*
+** Longest timeout that can be compared with wrapping 32 bit arithmetic.
+*/
+#define TIMER_MAX_TIMEOUT_MS 0x7FFFFFFFUL
+
 /*
 ** Timer resource structure
 */
@@ -19,26 +37,103 @@ typedef struct ABCC_TimerTimeoutType
 {
    BOOL  fActive;
    BOOL  fTmoOccured;
-   INT32 lTimeLeft;
+   UINT32 lExpireMs;
+   ABCC_TimerHandle xNext;
+   ABCC_TimerHandle xPrev;
    ABCC_TimerTimeoutCallbackType pnHandleTimeout;
 }
 ABCC_TimerTimeoutType;
-#define MAX_NUM_TIMERS 3
-static ABCC_TimerTimeoutType sTimer[ MAX_NUM_TIMERS ];
+
+static ABCC_TimerTimeoutType sTimer[ ABCC_CFG_MAX_NUM_TIMERS ];
+static ABCC_TimerHandle axWheel[ ABCC_CFG_TIMER_WHEEL_SIZE ];
 static BOOL fTimerEnabled = FALSE;
 static UINT64 llTotalTicks = 0;
+static UINT8 bNumActive = 0;       /* Number of running timers */
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+static UINT64 llStartTimeUs = 0;    /* Port clock when the timer was started */
+static UINT64 llLastTickTimeUs = 0; /* Port clock of the last counted tick */
+#endif
+
+/*------------------------------------------------------------------------------
+** Links a timer into the wheel slot of its expiry time.
+** Must be called within the timer critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle: Identifier of timer.
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void timer_Link( ABCC_TimerHandle xHandle )
+{
+   ABCC_TimerHandle* pxHead;
+
+   pxHead = &axWheel[ sTimer[ xHandle ].lExpireMs & TIMER_WHEEL_MASK ];
+
+   sTimer[ xHandle ].xPrev = ABCC_TIMER_NO_HANDLE;
+   sTimer[ xHandle ].xNext = *pxHead;
+
+   if( *pxHead != ABCC_TIMER_NO_HANDLE )
+   {
+      sTimer[ *pxHead ].xPrev = xHandle;
+   }
+
+   *pxHead = xHandle;
+}
+
+/*------------------------------------------------------------------------------
+** Unlinks a timer from its wheel slot.
+** Must be called within the timer critical section.
+**------------------------------------------------------------------------------
+** Arguments:
+**    xHandle: Identifier of timer.
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void timer_Unlink( ABCC_TimerHandle xHandle )
+{
+   const ABCC_TimerHandle xNext = sTimer[ xHandle ].xNext;
+   const ABCC_TimerHandle xPrev = sTimer[ xHandle ].xPrev;
+
+   if( xPrev != ABCC_TIMER_NO_HANDLE )
+   {
+      sTimer[ xPrev ].xNext = xNext;
+   }
+   else
+   {
+      axWheel[ sTimer[ xHandle ].lExpireMs & TIMER_WHEEL_MASK ] = xNext;
+   }
+
+   if( xNext != ABCC_TIMER_NO_HANDLE )
+   {
+      sTimer[ xNext ].xPrev = xPrev;
+   }
+}
 
 void ABCC_TimerInit( void )
 {
    ABCC_TimerHandle xHandle;
+   UINT16 iSlot;
 
-   for( xHandle = 0; xHandle < MAX_NUM_TIMERS; xHandle++ )
+   for( xHandle = 0; xHandle < ABCC_CFG_MAX_NUM_TIMERS; xHandle++ )
    {
       sTimer[ xHandle ].pnHandleTimeout = NULL;
+      sTimer[ xHandle ].fActive = FALSE;
+   }
+
+   for( iSlot = 0; iSlot < ABCC_CFG_TIMER_WHEEL_SIZE; iSlot++ )
+   {
+      axWheel[ iSlot ] = ABCC_TIMER_NO_HANDLE;
    }
    fTimerEnabled = TRUE;
+   bNumActive = 0;
 
    llTotalTicks = 0;
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+   llStartTimeUs = ABCC_PORT_GetMonotonicTimeUs();
+   llLastTickTimeUs = llStartTimeUs;
+#endif
 }
 
 ABCC_TimerHandle ABCC_TimerCreate( ABCC_TimerTimeoutCallbackType pnHandleTimeout )
@@ -48,7 +143,7 @@ ABCC_TimerHandle ABCC_TimerCreate( ABCC_TimerTimeoutCallbackType pnHandleTimeout
 
    ABCC_PORT_TIMER_EnterCritical();
 
-   for( xHandle = 0; xHandle < MAX_NUM_TIMERS; xHandle++ )
+   for( xHandle = 0; xHandle < ABCC_CFG_MAX_NUM_TIMERS; xHandle++ )
    {
       if( sTimer[ xHandle ].pnHandleTimeout == NULL )
       {
@@ -60,8 +155,11 @@ ABCC_TimerHandle ABCC_TimerCreate( ABCC_TimerTimeoutCallbackType pnHandleTimeout
    }
    ABCC_PORT_TIMER_ExitCritical();
 
-   if( xHandle >=  MAX_NUM_TIMERS )
+   if( xHandle >= ABCC_CFG_MAX_NUM_TIMERS )
    {
+      ABCC_LOG_ERROR( ABCC_EC_NO_RESOURCES,
+         ABCC_CFG_MAX_NUM_TIMERS,
+         "Out of timers, increase ABCC_CFG_MAX_NUM_TIMERS\n" );
       xHandle = ABCC_TIMER_NO_HANDLE;
    }
    return( xHandle );
@@ -73,7 +171,8 @@ BOOL ABCC_TimerStart( ABCC_TimerHandle xHandle,
    BOOL fTmo;
    ABCC_PORT_TIMER_UseCritical();
 
-   if( !sTimer[ xHandle ].pnHandleTimeout )
+   if( ( xHandle >= ABCC_CFG_MAX_NUM_TIMERS ) ||
+       !sTimer[ xHandle ].pnHandleTimeout )
    {
       ABCC_LOG_ERROR( ABCC_EC_UNEXPECTED_NULL_PTR,
          0,
@@ -81,11 +180,34 @@ BOOL ABCC_TimerStart( ABCC_TimerHandle xHandle,
       return( FALSE );
    }
 
+   /*
+   ** A timeout of 0 expires at the next tick, as does a timeout of 1.
+   */
+   if( lTimeoutMs == 0 )
+   {
+      lTimeoutMs = 1;
+   }
+   else if( lTimeoutMs > TIMER_MAX_TIMEOUT_MS )
+   {
+      lTimeoutMs = TIMER_MAX_TIMEOUT_MS;
+   }
+
    ABCC_PORT_TIMER_EnterCritical();
    fTmo = sTimer[ xHandle ].fTmoOccured;
-   sTimer[ xHandle ].lTimeLeft = (INT32)lTimeoutMs;
+
+   if( sTimer[ xHandle ].fActive )
+   {
+      timer_Unlink( xHandle );
+   }
+   else
+   {
+      bNumActive++;
+   }
+
+   sTimer[ xHandle ].lExpireMs = (UINT32)llTotalTicks + lTimeoutMs;
    sTimer[ xHandle ].fTmoOccured = FALSE;
    sTimer[ xHandle ].fActive = TRUE;
+   timer_Link( xHandle );
 
    ABCC_PORT_TIMER_ExitCritical();
    return( fTmo );
@@ -96,10 +218,21 @@ BOOL ABCC_TimerStop( ABCC_TimerHandle xHandle )
    BOOL fTmo;
    ABCC_PORT_TIMER_UseCritical();
 
+   if( xHandle >= ABCC_CFG_MAX_NUM_TIMERS )
+   {
+      return( FALSE );
+   }
+
    ABCC_PORT_TIMER_EnterCritical();
    fTmo = sTimer[ xHandle ].fTmoOccured;
 
-   sTimer[ xHandle ].fActive = FALSE;
+   if( sTimer[ xHandle ].fActive )
+   {
+      timer_Unlink( xHandle );
+      sTimer[ xHandle ].fActive = FALSE;
+      bNumActive--;
+   }
+
    sTimer[ xHandle ].fTmoOccured = FALSE;
 
    ABCC_PORT_TIMER_ExitCritical();
@@ -108,7 +241,14 @@ BOOL ABCC_TimerStop( ABCC_TimerHandle xHandle )
 
 void ABCC_TimerTick(const INT16 iDeltaTimeMs)
 {
+   ABCC_TimerHandle axExpired[ ABCC_CFG_MAX_NUM_TIMERS ];
+   UINT16 iNumExpired;
+   UINT16 iNumSlots;
+   UINT16 iIndex;
+   UINT32 lNow;
+   UINT32 lDeltaTimeMs;
    ABCC_TimerHandle xHandle;
+   ABCC_TimerHandle xNext;
    ABCC_PORT_TIMER_UseCritical();
 
    if( !fTimerEnabled )
@@ -116,26 +256,74 @@ void ABCC_TimerTick(const INT16 iDeltaTimeMs)
       return;
    }
 
+   iNumExpired = 0;
+
    ABCC_PORT_TIMER_EnterCritical();
 
-   for( xHandle = 0; xHandle < MAX_NUM_TIMERS; xHandle++ )
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+   /*
+   ** Count the whole milliseconds elapsed on the port clock. The remainder is
+   ** kept for the next tick so that the timer system does not drift.
+   */
+   (void)iDeltaTimeMs;
+   lDeltaTimeMs = (UINT32)( ( ABCC_PORT_GetMonotonicTimeUs() - llLastTickTimeUs ) / 1000 );
+   llLastTickTimeUs += (UINT64)lDeltaTimeMs * 1000;
+#else
+   lDeltaTimeMs = iDeltaTimeMs > 0 ? (UINT32)iDeltaTimeMs : 0;
+#endif
+
+   if( lDeltaTimeMs == 0 )
    {
-       if( ( sTimer[ xHandle ].pnHandleTimeout != NULL ) &&
-             ( sTimer[ xHandle ].fActive == TRUE ) )
-       {
-          sTimer[ xHandle ].lTimeLeft -= (INT32)iDeltaTimeMs;
-          if( sTimer[ xHandle ].lTimeLeft <= 0 )
-          {
-             sTimer[ xHandle ].fTmoOccured = TRUE;
-             sTimer[ xHandle ].fActive = FALSE;
-             sTimer[ xHandle ].pnHandleTimeout();
-          }
-       }
+      ABCC_PORT_TIMER_ExitCritical();
+      return;
    }
 
-   llTotalTicks += iDeltaTimeMs;
+   lNow = (UINT32)llTotalTicks;
+   llTotalTicks += lDeltaTimeMs;
+
+   /*
+   ** Visit the slots for the elapsed time, at most one full turn of the wheel.
+   ** Timers found there that are due are removed from the wheel, timers that
+   ** expire in a later turn are left in place.
+   */
+   iNumSlots = ( lDeltaTimeMs < ABCC_CFG_TIMER_WHEEL_SIZE ) ?
+               (UINT16)lDeltaTimeMs : ABCC_CFG_TIMER_WHEEL_SIZE;
+
+   for( iIndex = 0; iIndex < iNumSlots; iIndex++ )
+   {
+      lNow++;
+      xHandle = axWheel[ lNow & TIMER_WHEEL_MASK ];
+
+      while( xHandle != ABCC_TIMER_NO_HANDLE )
+      {
+         xNext = sTimer[ xHandle ].xNext;
+
+         if( (INT32)( sTimer[ xHandle ].lExpireMs - (UINT32)llTotalTicks ) <= 0 )
+         {
+            timer_Unlink( xHandle );
+            sTimer[ xHandle ].fTmoOccured = TRUE;
+            sTimer[ xHandle ].fActive = FALSE;
+            bNumActive--;
+            axExpired[ iNumExpired++ ] = xHandle;
+         }
+
+         xHandle = xNext;
+      }
+   }
 
    ABCC_PORT_TIMER_ExitCritical();
+
+   /*
+   ** Call the timeout handlers outside the critical section. A timer that has
+   ** been restarted or stopped in the meantime is not reported.
+   */
+   for( iIndex = 0; iIndex < iNumExpired; iIndex++ )
+   {
+      if( sTimer[ axExpired[ iIndex ] ].fTmoOccured )
+      {
+         sTimer[ axExpired[ iIndex ] ].pnHandleTimeout();
+      }
+   }
 }
 
 void ABCC_TimerDisable( void )
@@ -144,6 +332,11 @@ void ABCC_TimerDisable( void )
 }
 
 UINT64 ABCC_TimerGetUptimeMs( void )
+{
+   return( ABCC_TimerGetUptimeUs() / 1000 );
+}
+
+UINT64 ABCC_TimerGetUptimeUs( void )
 {
    ABCC_PORT_TIMER_UseCritical();
 
@@ -151,9 +344,65 @@ UINT64 ABCC_TimerGetUptimeMs( void )
 
    ABCC_PORT_TIMER_EnterCritical();
 
-   llUptime = llTotalTicks;
+#ifdef ABCC_PORT_GetMonotonicTimeUs
+   llUptime = ABCC_PORT_GetMonotonicTimeUs() - llStartTimeUs;
+#else
+   llUptime = llTotalTicks * 1000;
+#endif
 
    ABCC_PORT_TIMER_ExitCritical();
 
    return( llUptime );
 }
+
+UINT32 ABCC_TimerNextDeadlineMs( void )
+{
+   UINT32 lDeadline;
+   UINT32 lSlot;
+   UINT32 lNow;
+   INT32 lTimeLeft;
+   ABCC_TimerHandle xHandle;
+   ABCC_PORT_TIMER_UseCritical();
+
+   lDeadline = ABCC_TIMER_NO_DEADLINE;
+
+   ABCC_PORT_TIMER_EnterCritical();
+
+   if( bNumActive > 0 )
+   {
+      /*
+      ** A timer found in slot lSlot from now expires in lSlot ms, or in a
+      ** later turn. Walk the slots until no closer timer can remain, i.e.
+      ** until the first slot with a timer due in this turn, or one full turn
+      ** if all timers expire in later turns.
+      */
+      lNow = (UINT32)llTotalTicks;
+
+      for( lSlot = 1;
+           ( lSlot <= ABCC_CFG_TIMER_WHEEL_SIZE ) && ( lSlot < lDeadline );
+           lSlot++ )
+      {
+         xHandle = axWheel[ ( lNow + lSlot ) & TIMER_WHEEL_MASK ];
+
+         while( xHandle != ABCC_TIMER_NO_HANDLE )
+         {
+            lTimeLeft = (INT32)( sTimer[ xHandle ].lExpireMs - lNow );
+
+            if( lTimeLeft <= 0 )
+            {
+               lDeadline = 0;
+            }
+            else if( (UINT32)lTimeLeft < lDeadline )
+            {
+               lDeadline = (UINT32)lTimeLeft;
+            }
+
+            xHandle = sTimer[ xHandle ].xNext;
+         }
+      }
+   }
+
+   ABCC_PORT_TIMER_ExitCritical();
+
+   return( lDeadline );
+}
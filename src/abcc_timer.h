@@ -83,6 +83,10 @@ EXTFUNC BOOL ABCC_TimerStop( ABCC_TimerHandle xHandle );
 /*------------------------------------------------------------------------------
 ** ABCC_TimerTick(). Provides delta time since last timer tick call.
 ** Typically called from timer interrupt.
+** The callbacks of expired timers are called after the timer critical section
+** has been left.
+** If ABCC_PORT_GetMonotonicTimeUs is defined the delta time is not used, the
+** elapsed time is then read from the port clock instead.
 **------------------------------------------------------------------------------
 ** Arguments:
 **    iDeltaTimeMs: Time in ms since last timerTick call
@@ -114,4 +118,29 @@ EXTFUNC void ABCC_TimerDisable( void );
 */
 EXTFUNC UINT64 ABCC_TimerGetUptimeMs( void );
 
+/*------------------------------------------------------------------------------
+** Get the time since the timer system was started in microseconds.
+** The resolution is one millisecond unless ABCC_PORT_GetMonotonicTimeUs is
+** defined.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+** Returns:
+**    Uptime of the timer system in microseconds.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT64 ABCC_TimerGetUptimeUs( void );
+
+/*------------------------------------------------------------------------------
+** Get the time until the first running timer expires.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+** Returns:
+**    Milliseconds until the next timer expires, 0 if a timer is already due.
+**    ABCC_TIMER_NO_DEADLINE if no timer is running.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC UINT32 ABCC_TimerNextDeadlineMs( void );
+
 #endif  /* inclusion lock */
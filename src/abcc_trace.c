@@ -0,0 +1,238 @@
+/*******************************************************************************
+** Copyright 2024-present HMS Industrial Networks AB.
+** Licensed under the MIT License.
+********************************************************************************
+** File Description:
+** Message and frame trace recorder.
+**
+** Each record has a fixed size and holds the first ABCC_CFG_TRACE_CAPTURE_SIZE
+** octets of the traced object. The ring buffer always keeps the most recent
+** records, older records are overwritten.
+********************************************************************************
+*/
+
+#include "abcc_config.h"
+#include "abcc_types.h"
+#include "abp.h"
+#include "abcc.h"
+#include "abcc_port.h"
+#include "abcc_trace.h"
+
+#if ABCC_CFG_TRACE_ENABLED
+
+#define TRACE_RING_MASK ( ABCC_CFG_TRACE_NUM_RECORDS - 1 )
+
+/*
+** Size of the ABP message header in octets.
+*/
+#define TRACE_MSG_HEADER_SIZE 12
+
+/*
+** Size of the record header preceding the captured data in the capture.
+*/
+#define TRACE_RECORD_HEADER_SIZE 4
+
+/*
+** pcap constants, see abcc_trace.h.
+*/
+#define TRACE_PCAP_MAGIC          0xA1B2C3D4UL
+#define TRACE_PCAP_VERSION        0x00040002UL /* 2.4 */
+#define TRACE_PCAP_GLOBAL_SIZE    24
+#define TRACE_PCAP_RECORD_SIZE    16
+
+/*------------------------------------------------------------------------------
+** Trace record.
+**
+** lSeq is the sequence number of the event held by the record, 0 while the
+** record is being written. The reader checks that lSeq is unchanged before
+** and after copying a record to detect that it was overwritten meanwhile.
+**------------------------------------------------------------------------------
+*/
+typedef struct
+{
+   volatile UINT32 lSeq;
+   UINT64 llTimestampUs;
+   UINT16 iOrigSize;
+   UINT16 iCapSize;
+   UINT8  bType;
+   UINT8  bEvent;
+   UINT32 alData[ ( ABCC_CFG_TRACE_CAPTURE_SIZE + 3 ) >> 2 ];
+}
+abcc_TraceRecordType;
+
+static abcc_TraceRecordType abcc_asTraceRecord[ ABCC_CFG_TRACE_NUM_RECORDS ];
+
+/*
+** Sequence number of the last reserved record, 0 if none.
+*/
+static UINT32 abcc_lTraceSeq;
+
+/*
+** Sequence number of the first record kept after ABCC_TraceClear().
+*/
+static UINT32 abcc_lTraceFirstSeq = 1;
+
+/*------------------------------------------------------------------------------
+** Reserves the next record in the ring buffer. The oldest record is
+** overwritten.
+**------------------------------------------------------------------------------
+** Arguments:
+**    plSeq - Sequence number assigned to the record.
+**
+** Returns:
+**    Pointer to the reserved record.
+**------------------------------------------------------------------------------
+*/
+static abcc_TraceRecordType* ReserveRecord( UINT32* plSeq )
+{
+   abcc_TraceRecordType* psRecord;
+   UINT32 lSeq;
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   lSeq = ++abcc_lTraceSeq;
+   if( lSeq == 0 )
+   {
+      /*
+      ** Sequence number 0 marks a record being written, skip it on wrap.
+      */
+      lSeq = ++abcc_lTraceSeq;
+   }
+   psRecord = &abcc_asTraceRecord[ lSeq & TRACE_RING_MASK ];
+   psRecord->lSeq = 0;
+   ABCC_PORT_MemoryBarrier();
+   ABCC_PORT_ExitCritical();
+
+   *plSeq = lSeq;
+
+   return( psRecord );
+}
+
+/*------------------------------------------------------------------------------
+** Writes a 32 bit value in little endian to a capture buffer.
+**------------------------------------------------------------------------------
+*/
+static void PutLe32( UINT32* plDest, UINT32 lValue )
+{
+   *plDest = lTOlLe( lValue );
+}
+
+void ABCC_TraceMsg( UINT8 bType, UINT8 bEvent, const ABP_MsgType* psMsg )
+{
+   abcc_TraceRecordType* psRecord;
+   UINT32 lSeq;
+   UINT64 llTimestampUs;
+   UINT16 iSize;
+
+   llTimestampUs = ABCC_GetUptimeUs();
+   iSize = TRACE_MSG_HEADER_SIZE + ABCC_GetMsgDataSize( psMsg );
+
+   psRecord = ReserveRecord( &lSeq );
+   psRecord->llTimestampUs = llTimestampUs;
+   psRecord->bType = bType;
+   psRecord->bEvent = bEvent;
+   psRecord->iOrigSize = iSize;
+   psRecord->iCapSize = iSize < ABCC_CFG_TRACE_CAPTURE_SIZE ? iSize : ABCC_CFG_TRACE_CAPTURE_SIZE;
+   ABCC_PORT_CopyOctets( psRecord->alData, 0, psMsg, 0, psRecord->iCapSize );
+   ABCC_PORT_MemoryBarrier();
+   psRecord->lSeq = lSeq;
+}
+
+void ABCC_TraceFrame( UINT8 bType, const void* pxData, UINT16 iSizeInOctets )
+{
+   abcc_TraceRecordType* psRecord;
+   UINT32 lSeq;
+   UINT64 llTimestampUs;
+
+   llTimestampUs = ABCC_GetUptimeUs();
+
+   psRecord = ReserveRecord( &lSeq );
+   psRecord->llTimestampUs = llTimestampUs;
+   psRecord->bType = bType;
+   psRecord->bEvent = ABCC_TRACE_EVENT_NONE;
+   psRecord->iOrigSize = iSizeInOctets;
+   psRecord->iCapSize = iSizeInOctets < ABCC_CFG_TRACE_CAPTURE_SIZE ? iSizeInOctets : ABCC_CFG_TRACE_CAPTURE_SIZE;
+   ABCC_PORT_CopyOctets( psRecord->alData, 0, pxData, 0, psRecord->iCapSize );
+   ABCC_PORT_MemoryBarrier();
+   psRecord->lSeq = lSeq;
+}
+
+UINT16 ABCC_TraceDump( ABCC_TraceWriteFuncType pnWrite )
+{
+   abcc_TraceRecordType sRecord;
+   UINT32 alHeader[ TRACE_PCAP_GLOBAL_SIZE >> 2 ];
+   UINT32 lSeq;
+   UINT32 lLastSeq;
+   UINT32 lNumSeq;
+   UINT16 iNumRecords;
+   const abcc_TraceRecordType* psRecord;
+   ABCC_PORT_UseCritical();
+
+   PutLe32( &alHeader[ 0 ], TRACE_PCAP_MAGIC );
+   PutLe32( &alHeader[ 1 ], TRACE_PCAP_VERSION );
+   PutLe32( &alHeader[ 2 ], 0 );
+   PutLe32( &alHeader[ 3 ], 0 );
+   PutLe32( &alHeader[ 4 ], ABCC_CFG_TRACE_CAPTURE_SIZE + TRACE_RECORD_HEADER_SIZE );
+   PutLe32( &alHeader[ 5 ], ABCC_TRACE_PCAP_LINKTYPE );
+   pnWrite( alHeader, TRACE_PCAP_GLOBAL_SIZE );
+
+   ABCC_PORT_EnterCritical();
+   lLastSeq = abcc_lTraceSeq;
+   lSeq = abcc_lTraceFirstSeq;
+   ABCC_PORT_ExitCritical();
+
+   lNumSeq = lLastSeq - lSeq + 1;
+   if( lNumSeq > ABCC_CFG_TRACE_NUM_RECORDS )
+   {
+      lSeq = lLastSeq - ABCC_CFG_TRACE_NUM_RECORDS + 1;
+      lNumSeq = ABCC_CFG_TRACE_NUM_RECORDS;
+   }
+
+   iNumRecords = 0;
+   for( ; lNumSeq > 0; lNumSeq--, lSeq++ )
+   {
+      psRecord = &abcc_asTraceRecord[ lSeq & TRACE_RING_MASK ];
+
+      /*
+      ** Skip records that have been overwritten or are being written, also
+      ** if that happens while the record is copied. The copy must stay between
+      ** the two checks.
+      */
+      if( ( lSeq == 0 ) || ( psRecord->lSeq != lSeq ) )
+      {
+         continue;
+      }
+
+      ABCC_PORT_MemoryBarrier();
+      sRecord = *psRecord;
+      ABCC_PORT_MemoryBarrier();
+
+      if( psRecord->lSeq != lSeq )
+      {
+         continue;
+      }
+
+      PutLe32( &alHeader[ 0 ], (UINT32)( sRecord.llTimestampUs / 1000000 ) );
+      PutLe32( &alHeader[ 1 ], (UINT32)( sRecord.llTimestampUs % 1000000 ) );
+      PutLe32( &alHeader[ 2 ], (UINT32)sRecord.iCapSize + TRACE_RECORD_HEADER_SIZE );
+      PutLe32( &alHeader[ 3 ], (UINT32)sRecord.iOrigSize + TRACE_RECORD_HEADER_SIZE );
+      PutLe32( &alHeader[ 4 ], (UINT32)sRecord.bType | ( (UINT32)sRecord.bEvent << 8 ) );
+      pnWrite( alHeader, TRACE_PCAP_RECORD_SIZE + TRACE_RECORD_HEADER_SIZE );
+      pnWrite( sRecord.alData, sRecord.iCapSize );
+
+      iNumRecords++;
+   }
+
+   return( iNumRecords );
+}
+
+void ABCC_TraceClear( void )
+{
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   abcc_lTraceFirstSeq = abcc_lTraceSeq + 1;
+   ABCC_PORT_ExitCritical();
+}
+
+#endif
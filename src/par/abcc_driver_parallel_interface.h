@@ -194,6 +194,24 @@ EXTFUNC void ABCC_DrvParSetAppStatus( ABP_AppStatusType eAppStatus );
 */
 EXTFUNC void ABCC_DrvParSetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize );
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*------------------------------------------------------------------------------
+** Prepares the process data sizes to use after a remap. The new sizes are
+** applied when psRemapRespMsg has been sent, see pnABCC_DrvPrepareRemap in
+** abcc_driver_interface.h.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psRemapRespMsg: Remap response message, NULL to cancel.
+**       iReadPdSize:    Size of read process data (bytes)
+**       iWritePdSize:   Size of write process data (bytes)
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParPrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+#endif
+
 /*------------------------------------------------------------------------------
 ** Sets the receiver buffer, to be used for the next read message.
 **------------------------------------------------------------------------------
@@ -334,6 +352,60 @@ EXTFUNC BOOL ABCC_DrvParIsSupervised( void );
 */
 EXTFUNC UINT8 ABCC_DrvParGetAnbStatus ( void );
 
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+/*------------------------------------------------------------------------------
+**  Reads the buffer control and Anybus status registers into the register
+**  shadows. Called at the start of each run cycle.
+**------------------------------------------------------------------------------
+** Arguments:
+**          -
+**
+** Returns:
+**          -
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParUpdateRegShadow( void );
+
+/*------------------------------------------------------------------------------
+**  Invalidates all register shadows. Called at the end of each run cycle.
+**------------------------------------------------------------------------------
+** Arguments:
+**          -
+**
+** Returns:
+**          -
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParInvalidateRegShadow( void );
+#endif
+
+#if ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+/*------------------------------------------------------------------------------
+**  Adds a byte range to the read process data ranges to read.
+**------------------------------------------------------------------------------
+** Arguments:
+**          iOffset - Offset of the range in octets.
+**          iSize   - Size of the range in octets.
+**
+** Returns:
+**          ABCC_EC_NO_ERROR or ABCC_EC_PARAMETER_NOT_VALID.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC ABCC_ErrorCodeType ABCC_DrvParAddRdPdRange( UINT16 iOffset, UINT16 iSize );
+
+/*------------------------------------------------------------------------------
+**  Removes all read process data ranges.
+**------------------------------------------------------------------------------
+** Arguments:
+**          -
+**
+** Returns:
+**          -
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvParClearRdPdRanges( void );
+#endif
+
 #endif  /* ABCC_CFG_DRV_PARALLEL_ENABLED */
 
 #endif  /* inclusion lock */
@@ -8,6 +8,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_PARALLEL
+
 #include "abcc_config.h"
 
 #if ABCC_CFG_DRV_PARALLEL_ENABLED
@@ -22,6 +24,7 @@
 #include "../abcc_handler.h"
 #include "../abcc_timer.h"
 #include "../abcc_command_sequencer.h"
+#include "abcc_driver_parallel_interface.h"
 
 #if ( ABCC_CFG_INT_ENABLE_MASK_PAR & ABP_INTMASK_SYNCIEN )
 #error "Use ABCC_CFG_USE_ABCC_SYNC_SIGNAL_ENABLED define in abcc_driver_config.h to choose sync interrupt source. Do not use ABP_INTMASK_SYNCIEN"
@@ -91,6 +94,13 @@ void ABCC_ParRunDriver( void )
       return;
    }
 
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   /*
+   ** Read the status registers once for the whole cycle.
+   */
+   ABCC_DrvParUpdateRegShadow();
+#endif
+
    if( ( ABCC_iInterruptEnableMask & ( ABP_INTMASK_WRMSGIEN | ABP_INTMASK_ANBRIEN ) ) == 0 )
    {
       ABCC_LinkCheckSendMessage();
@@ -113,6 +123,10 @@ void ABCC_ParRunDriver( void )
 #if ABCC_CFG_DRV_CMD_SEQ_ENABLED
    ABCC_CmdSequencerExec();
 #endif
+
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   ABCC_DrvParInvalidateRegShadow();
+#endif
 }
 #if ABCC_CFG_INT_ENABLED
 void ABCC_ParISR( void )
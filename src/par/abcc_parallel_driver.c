@@ -7,6 +7,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_PARALLEL
+
 #include "abcc_config.h"
 
 #if ABCC_CFG_DRV_PARALLEL_ENABLED
@@ -55,6 +57,12 @@ static  void* par_drv_pbRdPdBuffer;
 static UINT16   par_drv_iSizeOfReadPd;
 static UINT16   par_drv_iSizeOfWritePd;
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+static const ABP_MsgType* par_drv_psRemapRespMsg;   /* Remap response waiting to be written, NULL if none. */
+static UINT16   par_drv_iNextSizeOfReadPd;          /* Read PD size to use after the remap. */
+static UINT16   par_drv_iNextSizeOfWritePd;         /* Write PD size to use after the remap. */
+#endif
+
 static   UINT8    par_drv_bNbrOfCmds;          /* Number of commands supported by the application. */
 
 static const    UINT16   iWRPDFlag     = 0x01;
@@ -67,6 +75,39 @@ static const    UINT16   iAPPRCLRFlag  = 0x40;
 
 #define ABCC_MSG_HEADER_TYPE_SIZEOF 12
 
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+/*
+** Valid flags of the register shadows.
+*/
+#define PAR_DRV_SHADOW_BUFCTRL      0x01
+#define PAR_DRV_SHADOW_ANBSTATUS    0x02
+#define PAR_DRV_SHADOW_INTSTATUS    0x04
+
+static UINT8    par_drv_bShadowValid;        /* Valid register shadows, PAR_DRV_SHADOW_* */
+static UINT16   par_drv_iShadowBufCtrl;      /* Shadow of BUFCTRL (native endian) */
+static UINT16   par_drv_iShadowAnbStatus;    /* Shadow of ANBSTATUS (native endian) */
+static UINT16   par_drv_iShadowIntStatus;    /* Shadow of INTSTATUS (native endian) */
+#endif
+
+#if ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+/*
+** Read process data range in octets, [iStart, iEnd).
+*/
+typedef struct
+{
+   UINT16 iStart;
+   UINT16 iEnd;
+}
+par_drv_RdPdRangeType;
+
+/*
+** Sorted, non-adjacent ranges. One extra entry is used while a new range is
+** inserted.
+*/
+static par_drv_RdPdRangeType par_drv_asRdPdRange[ ABCC_CFG_PAR_MAX_NUM_RDPD_RANGES + 1 ];
+static UINT8                 par_drv_bNumRdPdRanges;
+#endif
+
 #ifdef ABCC_SYS_16_BIT_CHAR
 static const UINT16 iWrMsgAdrOffset =        ABP_WRMSG_ADR_OFFSET / 2;
 static const UINT16 iRdMsgAdrOffset =        ABP_RDMSG_ADR_OFFSET / 2;
@@ -75,7 +116,9 @@ static const UINT16 iLedStatusAdrOffset =    ABP_LEDSTATUS_ADR_OFFSET / 2;
 static const UINT16 iAppStatusAdrOffset =    ABP_APPSTATUS_ADR_OFFSET / 2;
 static const UINT16 iAnbStatusAdrOffset =    ABP_ANBSTATUS_ADR_OFFSET / 2;
 static const UINT16 iBufCtrlAdrOffset =      ABP_BUFCTRL_ADR_OFFSET / 2;
+#if !ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
 static const UINT16 iMsgHdrEndAdrOffset =    ABCC_MSG_HEADER_TYPE_SIZEOF / 2;
+#endif
 static const UINT16 iIntMaskAdrOffset =      ABP_INTMASK_ADR_OFFSET / 2;
 static const UINT16 iIntStatusAdrOffset =    ABP_INTSTATUS_ADR_OFFSET / 2;
 #else
@@ -86,22 +129,276 @@ static const UINT16 iLedStatusAdrOffset =    ABP_LEDSTATUS_ADR_OFFSET;
 static const UINT16 iAppStatusAdrOffset =    ABP_APPSTATUS_ADR_OFFSET;
 static const UINT16 iAnbStatusAdrOffset =    ABP_ANBSTATUS_ADR_OFFSET;
 static const UINT16 iBufCtrlAdrOffset =      ABP_BUFCTRL_ADR_OFFSET;
+#if !ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
 static const UINT16 iMsgHdrEndAdrOffset =    ABCC_MSG_HEADER_TYPE_SIZEOF;
+#endif
 static const UINT16 iIntMaskAdrOffset =      ABP_INTMASK_ADR_OFFSET;
 static const UINT16 iIntStatusAdrOffset =    ABP_INTSTATUS_ADR_OFFSET;
 
 #endif
 
+/*------------------------------------------------------------------------------
+** Reads the buffer control register, from the shadow if it is valid.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Buffer control register (native endian).
+**------------------------------------------------------------------------------
+*/
+static UINT16 par_drv_GetBufCtrl( void )
+{
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   if( par_drv_bShadowValid & PAR_DRV_SHADOW_BUFCTRL )
+   {
+      return( par_drv_iShadowBufCtrl );
+   }
+#endif
+   return( iLeExtBusTOi( ABCC_DrvRead16( iBufCtrlAdrOffset ) ) );
+}
+
+/*------------------------------------------------------------------------------
+** Writes the buffer control register. Writing a flag changes the state of the
+** register so the shadow is invalidated.
+**------------------------------------------------------------------------------
+** Arguments:
+**    iFlags - Buffer control flags to write (native endian).
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void par_drv_SetBufCtrl( UINT16 iFlags )
+{
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   par_drv_bShadowValid &= ~PAR_DRV_SHADOW_BUFCTRL;
+#endif
+   ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iFlags ) );
+}
+
+/*------------------------------------------------------------------------------
+** Reads the Anybus status register, from the shadow if it is valid.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    Anybus status register (native endian).
+**------------------------------------------------------------------------------
+*/
+static UINT16 par_drv_GetAnbStatus( void )
+{
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   if( par_drv_bShadowValid & PAR_DRV_SHADOW_ANBSTATUS )
+   {
+      return( par_drv_iShadowAnbStatus );
+   }
+#endif
+   return( iLeExtBusTOi( ABCC_DrvRead16( iAnbStatusAdrOffset ) ) );
+}
+
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+void ABCC_DrvParUpdateRegShadow( void )
+{
+#if ( ABP_BUFCTRL_ADR_OFFSET == ( ABP_ANBSTATUS_ADR_OFFSET + 2 ) )
+   UINT16 aiRegs[ 2 ];
+
+   /*
+   ** ANBSTATUS and BUFCTRL are adjacent, read both in one burst.
+   */
+   ABCC_DrvParallelRead( iAnbStatusAdrOffset, aiRegs, 2 * ABP_UINT16_SIZEOF );
+   par_drv_iShadowAnbStatus = iLeExtBusTOi( aiRegs[ 0 ] );
+   par_drv_iShadowBufCtrl = iLeExtBusTOi( aiRegs[ 1 ] );
+#else
+   par_drv_iShadowAnbStatus = iLeExtBusTOi( ABCC_DrvRead16( iAnbStatusAdrOffset ) );
+   par_drv_iShadowBufCtrl = iLeExtBusTOi( ABCC_DrvRead16( iBufCtrlAdrOffset ) );
+#endif
+
+   /*
+   ** The interrupt status register is only read when it is first used.
+   */
+   par_drv_bShadowValid = PAR_DRV_SHADOW_BUFCTRL | PAR_DRV_SHADOW_ANBSTATUS;
+}
+
+void ABCC_DrvParInvalidateRegShadow( void )
+{
+   par_drv_bShadowValid = 0;
+}
+#endif
+
 void ABCC_DrvParInit( UINT8 bOpmode )
 {
    (void)bOpmode;
 
    par_drv_iSizeOfReadPd  = 0;
    par_drv_iSizeOfWritePd = 0;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+   par_drv_psRemapRespMsg = NULL;
+#endif
    par_drv_bNbrOfCmds     = 0;
    par_drv_pbRdPdBuffer   = ABCC_DrvParallelGetRdPdBuffer();
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   par_drv_bShadowValid   = 0;
+#endif
+}
+
+#if ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+ABCC_ErrorCodeType ABCC_DrvParAddRdPdRange( UINT16 iOffset, UINT16 iSize )
+{
+   UINT16 iStart;
+   UINT16 iEnd;
+   UINT16 iGap;
+   UINT16 iMinGap;
+   UINT8  bFirst;
+   UINT8  bNext;
+   UINT8  bDst;
+   UINT8  bMerge;
+   ABCC_PORT_UseCritical();
+
+   if( ( iSize == 0 ) ||
+       ( (UINT32)iOffset + iSize > ABCC_CFG_MAX_PROCESS_DATA_SIZE ) )
+   {
+      return( ABCC_EC_PARAMETER_NOT_VALID );
+   }
+
+   /*
+   ** The process data is read 16 bits at a time, align the range.
+   */
+   iStart = iOffset & ~1;
+   iEnd = (UINT16)( ( (UINT32)iOffset + iSize + 1 ) & ~1 );
+
+   ABCC_PORT_EnterCritical();
+
+   /*
+   ** Find the first range that overlaps or is adjacent to the new one and
+   ** merge all following ranges that do so into it.
+   */
+   bFirst = 0;
+   while( ( bFirst < par_drv_bNumRdPdRanges ) &&
+          ( par_drv_asRdPdRange[ bFirst ].iEnd < iStart ) )
+   {
+      bFirst++;
+   }
+
+   bNext = bFirst;
+   while( ( bNext < par_drv_bNumRdPdRanges ) &&
+          ( par_drv_asRdPdRange[ bNext ].iStart <= iEnd ) )
+   {
+      if( par_drv_asRdPdRange[ bNext ].iStart < iStart )
+      {
+         iStart = par_drv_asRdPdRange[ bNext ].iStart;
+      }
+      if( par_drv_asRdPdRange[ bNext ].iEnd > iEnd )
+      {
+         iEnd = par_drv_asRdPdRange[ bNext ].iEnd;
+      }
+      bNext++;
+   }
+
+   if( bNext == bFirst )
+   {
+      /*
+      ** Nothing to merge, insert a new range.
+      */
+      for( bDst = par_drv_bNumRdPdRanges; bDst > bFirst; bDst-- )
+      {
+         par_drv_asRdPdRange[ bDst ] = par_drv_asRdPdRange[ bDst - 1 ];
+      }
+      par_drv_bNumRdPdRanges++;
+   }
+   else
+   {
+      /*
+      ** Remove the ranges merged into the first one.
+      */
+      for( bDst = bFirst + 1; bNext < par_drv_bNumRdPdRanges; bDst++, bNext++ )
+      {
+         par_drv_asRdPdRange[ bDst ] = par_drv_asRdPdRange[ bNext ];
+      }
+      par_drv_bNumRdPdRanges = bDst;
+   }
+
+   par_drv_asRdPdRange[ bFirst ].iStart = iStart;
+   par_drv_asRdPdRange[ bFirst ].iEnd = iEnd;
+
+   if( par_drv_bNumRdPdRanges > ABCC_CFG_PAR_MAX_NUM_RDPD_RANGES )
+   {
+      /*
+      ** Out of ranges, merge the two ranges with the smallest gap.
+      */
+      bMerge = 0;
+      iMinGap = 0xFFFF;
+      for( bDst = 0; bDst < par_drv_bNumRdPdRanges - 1; bDst++ )
+      {
+         iGap = par_drv_asRdPdRange[ bDst + 1 ].iStart - par_drv_asRdPdRange[ bDst ].iEnd;
+         if( iGap < iMinGap )
+         {
+            iMinGap = iGap;
+            bMerge = bDst;
+         }
+      }
+
+      par_drv_asRdPdRange[ bMerge ].iEnd = par_drv_asRdPdRange[ bMerge + 1 ].iEnd;
+      for( bDst = bMerge + 1; bDst < par_drv_bNumRdPdRanges - 1; bDst++ )
+      {
+         par_drv_asRdPdRange[ bDst ] = par_drv_asRdPdRange[ bDst + 1 ];
+      }
+      par_drv_bNumRdPdRanges--;
+   }
+
+   ABCC_PORT_ExitCritical();
+
+   return( ABCC_EC_NO_ERROR );
 }
 
+void ABCC_DrvParClearRdPdRanges( void )
+{
+   par_drv_bNumRdPdRanges = 0;
+}
+
+/*------------------------------------------------------------------------------
+** Reads the registered read process data ranges that are within the current
+** read process data size.
+**------------------------------------------------------------------------------
+** Arguments:
+**    None
+**
+** Returns:
+**    None
+**------------------------------------------------------------------------------
+*/
+static void par_drv_ReadRdPdRanges( void )
+{
+   UINT8  bIndex;
+   UINT16 iEnd;
+
+   for( bIndex = 0; bIndex < par_drv_bNumRdPdRanges; bIndex++ )
+   {
+      if( par_drv_asRdPdRange[ bIndex ].iStart >= par_drv_iSizeOfReadPd )
+      {
+         break;
+      }
+
+      iEnd = par_drv_asRdPdRange[ bIndex ].iEnd;
+      if( iEnd > par_drv_iSizeOfReadPd )
+      {
+         iEnd = par_drv_iSizeOfReadPd;
+      }
+
+#ifdef ABCC_SYS_16_BIT_CHAR
+      ABCC_HAL_ParallelRead( ABP_RDPD_ADR_OFFSET + ( par_drv_asRdPdRange[ bIndex ].iStart >> 1 ),
+                             (UINT16*)par_drv_pbRdPdBuffer + ( par_drv_asRdPdRange[ bIndex ].iStart >> 1 ),
+                             iEnd - par_drv_asRdPdRange[ bIndex ].iStart );
+#else
+      ABCC_HAL_ParallelRead( ABP_RDPD_ADR_OFFSET + par_drv_asRdPdRange[ bIndex ].iStart,
+                             (UINT8*)par_drv_pbRdPdBuffer + par_drv_asRdPdRange[ bIndex ].iStart,
+                             iEnd - par_drv_asRdPdRange[ bIndex ].iStart );
+#endif
+   }
+}
+#endif
+
 
 void ABCC_DrvParSetIntMask( const UINT16 iIntMask )
 {
@@ -114,6 +411,14 @@ UINT16 ABCC_DrvParISR( void )
    UINT16 iIntStatus;
    UINT16 iIntToHandle;
 
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   /*
+   ** The ISR may have interrupted a run cycle and the events it acknowledges
+   ** are handled based on current register values.
+   */
+   par_drv_bShadowValid = 0;
+#endif
+
    /*---------------------------------------------------------------------------
    ** Read the interrupt status register and acknowledge all interrupts.
    ** Read interrupt status until all enabled interrupts are acknowledged.
@@ -211,7 +516,20 @@ BOOL ABCC_DrvParWriteMessage( ABP_MsgType* psWriteMsg )
    ** Update the buffer control register.
    */
 
-   ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iBufControlWriteFlags ) );
+   par_drv_SetBufCtrl( iBufControlWriteFlags );
+
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+   if( ( par_drv_psRemapRespMsg != NULL ) && ( par_drv_psRemapRespMsg == psWriteMsg ) )
+   {
+      /*
+      ** The remap response has been handed over to the ABCC. Process data
+      ** from now on uses the prepared sizes.
+      */
+      par_drv_iSizeOfReadPd = par_drv_iNextSizeOfReadPd;
+      par_drv_iSizeOfWritePd = par_drv_iNextSizeOfWritePd;
+      par_drv_psRemapRespMsg = NULL;
+   }
+#endif
 #ifdef MSG_TIMING
    /*Toggle led for timing measurement*/
    GPIO_OUT0  = 1;
@@ -238,7 +556,7 @@ void ABCC_DrvParWriteProcessData( void* pxProcessData )
       /*
       ** Update the buffer control register.
       */
-      ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iWRPDFlag ) );
+      par_drv_SetBufCtrl( iWRPDFlag );
 #ifdef PD_TIMING
       /*Toggle led for timing measurement*/
       GPIO_OUT0  = 1;
@@ -250,17 +568,16 @@ void ABCC_DrvParWriteProcessData( void* pxProcessData )
 BOOL ABCC_DrvParIsReadyForWriteMessage( void )
 {
    UINT16 iBufControl;
-   iBufControl = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   iBufControl = par_drv_GetBufCtrl();
 
-   return( !( iLeExtBusTOi( iBufControl ) & iWRMSGFlag ) );
+   return( !( iBufControl & iWRMSGFlag ) );
 }
 
 
 BOOL ABCC_DrvParIsReadyForCmd( void )
 {
    UINT16 iBufControl;
-   iBufControl = ABCC_DrvRead16( iBufCtrlAdrOffset );
-   iBufControl = iLeExtBusTOi( iBufControl );
+   iBufControl = par_drv_GetBufCtrl();
    return( !( iBufControl & iWRMSGFlag ) && ( iBufControl & iANBRFlag ) );
 }
 
@@ -272,7 +589,7 @@ void ABCC_DrvParSetNbrOfCmds( UINT8 bNbrOfCmds )
    /*
    ** Acknowledge that we are ready to accept the first command message.
    */
-   ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iAPPRFlag ) );
+   par_drv_SetBufCtrl( iAPPRFlag );
 }
 
 
@@ -289,6 +606,19 @@ void ABCC_DrvParSetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize )
    (void)par_drv_iSizeOfReadPd;
 }
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+void ABCC_DrvParPrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize )
+{
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   par_drv_iNextSizeOfReadPd = iReadPdSize;
+   par_drv_iNextSizeOfWritePd = iWritePdSize;
+   par_drv_psRemapRespMsg = psRemapRespMsg;
+   ABCC_PORT_ExitCritical();
+}
+#endif
+
 
 static void DrvParSetMsgReceiverBuffer( ABP_MsgType* const psReadMsg )
 {
@@ -300,6 +630,23 @@ UINT16 ABCC_DrvParGetIntStatus( void )
 {
    UINT16 iIntStatus;
 
+#if ABCC_CFG_PAR_REG_SHADOW_ENABLED
+   if( par_drv_bShadowValid & PAR_DRV_SHADOW_ANBSTATUS )
+   {
+      /*
+      ** The Anybus status shadow is only valid within a run cycle. Read the
+      ** interrupt status once per cycle and keep the shadow.
+      */
+      if( !( par_drv_bShadowValid & PAR_DRV_SHADOW_INTSTATUS ) )
+      {
+         par_drv_iShadowIntStatus = iLeExtBusTOi( ABCC_DrvRead16( iIntStatusAdrOffset ) );
+         par_drv_bShadowValid |= PAR_DRV_SHADOW_INTSTATUS;
+      }
+
+      return( par_drv_iShadowIntStatus );
+   }
+#endif
+
    iIntStatus = ABCC_DrvRead16( iIntStatusAdrOffset );
 
    return( iLeExtBusTOi( iIntStatus ) );
@@ -312,12 +659,12 @@ UINT8 ABCC_DrvParGetAnybusState( void )
    /*
    ** Reading out the Anybus status.
    */
-   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
+   iAnbStatus = par_drv_GetAnbStatus();
 
    /*
    ** The Anybus state is stored in bits 0-2 of the read register.
    */
-   return( (UINT8)( iLeExtBusTOi( iAnbStatus ) & 0x07 ) );
+   return( (UINT8)( iAnbStatus & 0x07 ) );
 }
 
 
@@ -328,24 +675,33 @@ void* ABCC_DrvParReadProcessData( void )
    /*
    ** Check if the Anybus has updated the read process data.
    */
-   iBufctrl = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   iBufctrl = par_drv_GetBufCtrl();
 
-   if( iLeExtBusTOi( iBufctrl ) & iRDPDFlag  )
+   if( iBufctrl & iRDPDFlag  )
    {
       /*
       ** The RDPD flag must be set before we try to read the process data.
       ** Otherwise the buffers won't be switched and we won't have any process
       ** data available.
       */
-      ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iRDPDFlag ) );
+      par_drv_SetBufCtrl( iRDPDFlag );
 
       /*
       ** We have process data to read.
       */
 #if !( ABCC_CFG_MEMORY_MAPPED_ACCESS_ENABLED )
-      ABCC_HAL_ParallelRead( ABP_RDPD_ADR_OFFSET,
-                             par_drv_pbRdPdBuffer,
-                             par_drv_iSizeOfReadPd );
+#if ABCC_CFG_PAR_RDPD_RANGES_ENABLED
+      if( par_drv_bNumRdPdRanges > 0 )
+      {
+         par_drv_ReadRdPdRanges();
+      }
+      else
+#endif
+      {
+         ABCC_HAL_ParallelRead( ABP_RDPD_ADR_OFFSET,
+                                par_drv_pbRdPdBuffer,
+                                par_drv_iSizeOfReadPd );
+      }
 #endif
 
       return( par_drv_pbRdPdBuffer );
@@ -362,10 +718,27 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
    UINT16 iBufctrl;
    UINT16 iMsgSize;
 
-   iBufctrl = ABCC_DrvRead16( iBufCtrlAdrOffset );
+   iBufctrl = par_drv_GetBufCtrl();
 
-   if( iLeExtBusTOi( iBufctrl ) & iRDMSGFlag  )
+   if( iBufctrl & iRDMSGFlag  )
    {
+#if ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
+      ABCC_MsgType uRdMsgView;
+
+      /*
+      ** The read message area is memory mapped, offer responses to the
+      ** application in place before allocating a buffer.
+      */
+      uRdMsgView.psMsg = (ABP_MsgType*)( ABCC_CFG_PARALLEL_BASE_ADR + iRdMsgAdrOffset );
+
+      if( !( ABCC_GetLowAddrOct( uRdMsgView.psMsg16->sHeader.iCmdReserved ) & ABP_MSG_HEADER_C_BIT ) &&
+          ABCC_HandleResponseInPlace( uRdMsgView.psMsg ) )
+      {
+         par_drv_SetBufCtrl( iRDMSGFlag );
+
+         return( NULL );
+      }
+#endif
       DrvParSetMsgReceiverBuffer( ABCC_MemAlloc() );
 
       if( par_drv_uReadMessageData.psMsg == NULL )
@@ -376,6 +749,22 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
          return( NULL );
       }
 
+#if ABCC_CFG_PAR_RDMSG_ZERO_COPY_ENABLED
+      /*
+      ** The size is available in place, copy the header and the data in one
+      ** go.
+      */
+      iMsgSize = iLeTOi( uRdMsgView.psMsg16->sHeader.iDataSize );
+
+      if( iMsgSize > ABCC_CFG_MAX_MSG_SIZE )
+      {
+         iMsgSize = 0;
+      }
+
+      ABCC_DrvParallelRead( iRdMsgAdrOffset,
+                            par_drv_uReadMessageData.psMsg16,
+                            ABCC_MSG_HEADER_TYPE_SIZEOF + iMsgSize );
+#else
       /*
       ** We have message data to read. First read the header and check the size
       ** of data area.
@@ -396,6 +785,7 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
                                par_drv_uReadMessageData.psMsg16->aiData,
                                iMsgSize );
       }
+#endif
 
       /*
       ** Determine if command messages (instead of response messages) can be read.
@@ -420,11 +810,11 @@ ABP_MsgType* ABCC_DrvParReadMessage( void )
             /*
             ** Update the buffer control register.
             */
-            ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iAPPRCLRFlag ) );
+            par_drv_SetBufCtrl( iAPPRCLRFlag );
          }
       }
 
-      ABCC_DrvWrite16( iBufCtrlAdrOffset, iTOiLeExtBus( iRDMSGFlag ) );
+      par_drv_SetBufCtrl( iRDMSGFlag );
 
       return( par_drv_uReadMessageData.psMsg );
    }
@@ -466,8 +856,7 @@ BOOL ABCC_DrvParIsSupervised( void )
    /*
    ** Reading out the Anybus status.
    */
-   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
-   iAnbStatus = iLeExtBusTOi( iAnbStatus );
+   iAnbStatus = par_drv_GetAnbStatus();
 
    /*
    ** The Anybus supervision bis is stored in bit 3
@@ -482,8 +871,7 @@ UINT8 ABCC_DrvParGetAnbStatus( void )
    /*
    ** Reading out the Anybus status.
    */
-   iAnbStatus = ABCC_DrvRead16( iAnbStatusAdrOffset );
-   iAnbStatus = iLeExtBusTOi( iAnbStatus );
+   iAnbStatus = par_drv_GetAnbStatus();
    return( (UINT8)iAnbStatus & 0xf );
 
 }
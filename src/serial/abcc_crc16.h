@@ -13,6 +13,11 @@
 #include "abcc_config.h"
 #include "abcc_types.h"
 
+/*
+** Initial value of a CRC16 calculation done with CRC_Crc16Update().
+*/
+#define CRC_CRC16_INIT_VALUE  0xFFFF
+
 /*---------------------------------------------------------------------------
 **
 ** CRC_Crc16()
@@ -36,4 +41,33 @@
 
 EXTFUNC UINT16 CRC_Crc16( UINT8* pbBufferStart, UINT16 iLength );
 
+/*---------------------------------------------------------------------------
+**
+** CRC_Crc16Update()
+**
+** Continues a CRC16 calculation over the indicated bytes. Allows the checksum
+** of a telegram to be calculated in chunks, e.g. while it is being received.
+** Calculating the CRC over a buffer in several chunks gives the same result
+** as calling CRC_Crc16() once on the whole buffer.
+**
+**---------------------------------------------------------------------------
+**
+** Inputs:
+**    iCrc                     - CRC calculated so far, CRC_CRC16_INIT_VALUE
+**                               for the first chunk
+**    pbBufferStart            - Where to continue calculation
+**    iLength                  - The amount of bytes to include
+**
+** Outputs:
+**    Returns                  - The updated CRC16 checksum
+**
+** Usage:
+**    iCrc = CRC_Crc16Update( CRC_CRC16_INIT_VALUE, pbStart, 10 );
+**    iCrc = CRC_Crc16Update( iCrc, pbStart + 10, 10 );
+**
+**---------------------------------------------------------------------------
+*/
+
+EXTFUNC UINT16 CRC_Crc16Update( UINT16 iCrc, const UINT8* pbBufferStart, UINT16 iLength );
+
 #endif  /* inclusion lock */
@@ -21,8 +21,8 @@
 ** The reason for this special callback is that the read remap in serial
 ** operating mode is a unique case where the the position for rx frame size
 ** update only can be decided on a lower level.
-** It is required that the new RdPd size is passed to the serial driver
-** before return from this function.
+** The RdPd size prepared by ABCC_DrvSerPrepareRemap() has already been applied
+** when this function is called.
 **------------------------------------------------------------------------------
 ** Arguments:
 **       psMsg:   Pointer to sent read remap response message.
@@ -202,6 +202,24 @@ EXTFUNC void ABCC_DrvSerSetAppStatus( ABP_AppStatusType eAppStatus );
 */
 EXTFUNC void ABCC_DrvSerSetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize );
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*------------------------------------------------------------------------------
+** Prepares the process data sizes to use after a remap. The new sizes are
+** applied when psRemapRespMsg has been sent, see pnABCC_DrvPrepareRemap in
+** abcc_driver_interface.h.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psRemapRespMsg: Remap response message, NULL to cancel.
+**       iReadPdSize:    Size of read process data (bytes)
+**       iWritePdSize:   Size of write process data (bytes)
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvSerPrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+#endif
+
 
 /*------------------------------------------------------------------------------
 ** Sets the receiver buffer, to be used for the next read message.
@@ -3,6 +3,8 @@
 ** Licensed under the MIT License.
 ********************************************************************************
 */
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_SERIAL
+
 #include "abcc_config.h"
 
 #if ABCC_CFG_DRV_SERIAL_ENABLED
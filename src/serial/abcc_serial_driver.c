@@ -8,6 +8,8 @@
 ** Implementation of serial driver ping protocol
 ********************************************************************************
 */
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_SERIAL
+
 #include "abcc_config.h"
 
 #if ABCC_CFG_DRV_SERIAL_ENABLED
@@ -16,6 +18,7 @@
 #include "abp.h"
 #include "abcc.h"
 #include "abcc_log.h"
+#include "abcc_trace.h"
 #include "abcc_hardware_abstraction.h"
 #include "../abcc_timer.h"
 #include "../abcc_driver_interface.h"
@@ -83,6 +86,21 @@ typedef enum
    SM_SER_WAITING_FOR_PONG
 } drv_SerStateType;
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*
+** PD sizes and frame sizes prepared for a remap, applied when the remap
+** response has been sent.
+*/
+typedef struct
+{
+   const ABP_MsgType* psRemapRespMsg;   /* Remap response, NULL if none pending. */
+   UINT16             iWritePdSize;
+   UINT16             iReadPdSize;
+   UINT16             iTxFrameSize;
+   UINT16             iRxFrameSize;
+} drv_SerPdLayoutType;
+#endif
+
 /*------------------------------------------------------------------------------
 ** General privates.
 **------------------------------------------------------------------------------
@@ -100,6 +118,9 @@ static UINT16            drv_iReadPdSize;            /* Current read PD size. */
 
 static UINT16            drv_iTxFrameSize;           /* Current ping frame size. */
 static UINT16            drv_iRxFrameSize;           /* Current ping frame size. */
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+static drv_SerPdLayoutType drv_sNextPdLayout;        /* PD sizes to switch to after a remap. */
+#endif
 
 static UINT8             drv_bNbrOfCmds;             /* Number of commands that can be received by the application */
 
@@ -114,6 +135,10 @@ static BOOL              drv_fNewRxTelegramReceived; /* Serail driver has a comp
 static UINT8*            drv_bpRdPd;                 /* Pointer to valid read process data */
 
 static UINT16            drv_iCrcErrorCount;         /* CRC error counter */
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+static UINT16            drv_iRxCrc;                 /* CRC of the RX telegram bytes received so far */
+static UINT16            drv_iRxCrcNumBytes;         /* Number of RX telegram bytes included in drv_iRxCrc */
+#endif
 /*
 ** Timers and watchdogs
 */
@@ -122,6 +147,14 @@ static BOOL             fWdTmo;             /* Current wd timeout status */
 static ABCC_TimerHandle xTelegramTmoHandle;
 static BOOL             fTelegramTmo;       /* Current telegram tmo status */
 static UINT16           iTelegramTmoMs;     /* Telegram timeout  */
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+static UINT16           iTelegramTmoMaxMs;  /* Upper bound of the telegram timeout */
+static BOOL             fRttValid;          /* At least one round trip time is measured */
+static BOOL             fRttSample;         /* Current ping is used for round trip time measurement */
+static UINT32           lPingSentUs;        /* Uptime when the current ping was sent */
+static INT32            lSmoothedRtt8;      /* Smoothed round trip time in ms, scaled by 8 */
+static INT32            lRttVar4;           /* Round trip time variation in ms, scaled by 4 */
+#endif
 
 
 /*******************************************************************************
@@ -129,6 +162,9 @@ static UINT16           iTelegramTmoMs;     /* Telegram timeout  */
 ********************************************************************************
 */
 static void DrvSerSetMsgReceiverBuffer( ABP_MsgType* const psReadMsg );
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+static void drv_SwitchPdLayout( const ABP_MsgType* psSentMsg );
+#endif
 
 /*------------------------------------------------------------------------------
 ** Callback from the physical layer to indicate that a RX telegran was received.
@@ -145,6 +181,53 @@ static void drv_RxTelegramReceived( void )
    drv_fNewRxTelegramReceived = TRUE;
 }
 
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+/*------------------------------------------------------------------------------
+** Callback from the physical layer to indicate that a part of the RX telegram
+** was received. Updates the RX CRC with the new bytes. The CRC bytes at the end
+** of the telegram are not included.
+**------------------------------------------------------------------------------
+** Arguments:
+**       iNumBytesReceived - Total number of RX telegram bytes received so far.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void drv_RxChunkReceived( UINT16 iNumBytesReceived )
+{
+   if( iNumBytesReceived > drv_iRxFrameSize )
+   {
+      iNumBytesReceived = drv_iRxFrameSize;
+   }
+
+   if( iNumBytesReceived > drv_iRxCrcNumBytes )
+   {
+      drv_iRxCrc = CRC_Crc16Update( drv_iRxCrc,
+                                    (UINT8*)&drv_sRxTelegram + drv_iRxCrcNumBytes,
+                                    iNumBytesReceived - drv_iRxCrcNumBytes );
+      drv_iRxCrcNumBytes = iNumBytesReceived;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Restarts the RX CRC calculation. Must be called before a new RX telegram
+** reception is started.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void drv_RxCrcRestart( void )
+{
+   drv_iRxCrc = CRC_CRC16_INIT_VALUE;
+   drv_iRxCrcNumBytes = 0;
+}
+#endif
+
 /*------------------------------------------------------------------------------
 ** Init write message fragmentation
 **------------------------------------------------------------------------------
@@ -314,6 +397,85 @@ static void drv_TelegramTimeoutHandler( void )
    fTelegramTmo = TRUE;
 }
 
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+/*------------------------------------------------------------------------------
+** Updates the smoothed round trip time and variation with a new measurement
+** and calculates a new telegram timeout. Integer version of the algorithm in
+** RFC 6298, the timeout is SRTT + 4 * RTTVAR bounded by
+** ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS and iTelegramTmoMaxMs.
+**------------------------------------------------------------------------------
+** Arguments:
+**       lRttMs - Measured round trip time in ms.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void drv_UpdateTelegramTmo( UINT32 lRttMs )
+{
+   INT32 lErr;
+   INT32 lTmoMs;
+
+   if( lRttMs > iTelegramTmoMaxMs )
+   {
+      lRttMs = iTelegramTmoMaxMs;
+   }
+
+   if( !fRttValid )
+   {
+      lSmoothedRtt8 = (INT32)lRttMs << 3;
+      lRttVar4 = (INT32)lRttMs << 1;
+      fRttValid = TRUE;
+   }
+   else
+   {
+      lErr = (INT32)lRttMs - ( lSmoothedRtt8 >> 3 );
+      lSmoothedRtt8 += lErr;
+      if( lErr < 0 )
+      {
+         lErr = -lErr;
+      }
+      lRttVar4 += lErr - ( lRttVar4 >> 2 );
+   }
+
+   lTmoMs = ( lSmoothedRtt8 >> 3 ) + lRttVar4;
+
+   if( lTmoMs < ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS )
+   {
+      lTmoMs = ABCC_CFG_SERIAL_ADAPTIVE_TMO_MIN_MS;
+   }
+   else if( lTmoMs > iTelegramTmoMaxMs )
+   {
+      lTmoMs = iTelegramTmoMaxMs;
+   }
+
+   iTelegramTmoMs = (UINT16)lTmoMs;
+}
+
+/*------------------------------------------------------------------------------
+** Backs off the telegram timeout after a telegram timeout. The timeout is
+** doubled up to iTelegramTmoMaxMs.
+**------------------------------------------------------------------------------
+** Arguments:
+**       None.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void drv_BackOffTelegramTmo( void )
+{
+   if( iTelegramTmoMs > ( iTelegramTmoMaxMs >> 1 ) )
+   {
+      iTelegramTmoMs = iTelegramTmoMaxMs;
+   }
+   else
+   {
+      iTelegramTmoMs <<= 1;
+   }
+}
+#endif
+
 void ABCC_DrvSerInit( UINT8 bOpmode )
 {
    if( ( bOpmode != ABP_OP_MODE_SERIAL_19_2 ) &&
@@ -343,6 +505,9 @@ void ABCC_DrvSerInit( UINT8 bOpmode )
 
    drv_iTxFrameSize = SER_CMD_STAT_REG_LEN + SER_MSG_FRAG_LEN + drv_iWritePdSize;
    drv_iRxFrameSize = SER_CMD_STAT_REG_LEN + SER_MSG_FRAG_LEN + drv_iReadPdSize;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+   drv_sNextPdLayout.psRemapRespMsg = NULL;
+#endif
 
    drv_bpRdPd = NULL;
 
@@ -381,6 +546,16 @@ void ABCC_DrvSerInit( UINT8 bOpmode )
       break;
    }
 
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+   /*
+   ** The configured timeout is used until the first round trip time has been
+   ** measured and is the upper bound of the adaptive timeout.
+   */
+   iTelegramTmoMaxMs = iTelegramTmoMs;
+   fRttValid = FALSE;
+   fRttSample = FALSE;
+#endif
+
    xWdTmoHandle = ABCC_TimerCreate( drv_WdTimeoutHandler );
    fWdTmo = FALSE;
 
@@ -388,6 +563,11 @@ void ABCC_DrvSerInit( UINT8 bOpmode )
    ** Register the PONG indicator for the physical serial driver.
    */
    ABCC_HAL_SerRegDataReceived( drv_RxTelegramReceived );
+
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+   drv_RxCrcRestart();
+   ABCC_HAL_SerRegRxChunkReceived( drv_RxChunkReceived );
+#endif
 }
 
 /*------------------------------------------------------------------------------
@@ -430,6 +610,13 @@ void ABCC_DrvSerRunDriverTx( void )
          ABCC_PORT_ExitCritical();
       }
 
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+      /*
+      ** Only measure the round trip time of telegrams that are not
+      ** retransmissions, the pong could otherwise belong to an earlier ping.
+      */
+      fRttSample = !fTelegramTmo;
+#endif
       fTelegramTmo = FALSE;
 
       /*---------------------------------------------------------------------------
@@ -461,6 +648,9 @@ void ABCC_DrvSerRunDriverTx( void )
             if( ( drv_psWriteMessage->sHeader.bDestObj == ABP_OBJ_NUM_APPD ) &&
                 ( drv_psWriteMessage->sHeader.bCmd == ABP_APPD_REMAP_ADI_READ_AREA ) )
             {
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+               drv_SwitchPdLayout( drv_psWriteMessage );
+#endif
                if( pnABCC_DrvCbfReadRemapDone != NULL )
                {
                   pnABCC_DrvCbfReadRemapDone( drv_psWriteMessage );
@@ -488,7 +678,14 @@ void ABCC_DrvSerRunDriverTx( void )
       ** Send  TX telegram and received Rx telegram.
       */
       ABCC_LOG_DEBUG_UART_HEXDUMP_TX( (UINT8*)&drv_sTxTelegram, drv_iTxFrameSize + SER_CRC_LEN );
+      ABCC_TRACE_UART_TX( &drv_sTxTelegram, drv_iTxFrameSize + SER_CRC_LEN );
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+      lPingSentUs = (UINT32)ABCC_TimerGetUptimeUs();
+#endif
       ABCC_TimerStart( xTelegramTmoHandle, iTelegramTmoMs );
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+      drv_RxCrcRestart();
+#endif
       ABCC_HAL_SerSendReceive( (UINT8*)&drv_sTxTelegram,  (UINT8*)&drv_sRxTelegram, drv_iTxFrameSize + SER_CRC_LEN, drv_iRxFrameSize + SER_CRC_LEN );
    }
 }
@@ -516,6 +713,12 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
       {
          if( fTelegramTmo )
          {
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+            drv_BackOffTelegramTmo();
+#endif
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+            drv_RxCrcRestart();
+#endif
             ABCC_HAL_SerRestart();
             drv_eState = SM_SER_RDY_TO_SEND_PING;
          }
@@ -532,8 +735,22 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
       drv_fNewRxTelegramReceived = FALSE;
 
       ABCC_LOG_DEBUG_UART_HEXDUMP_RX( (UINT8*)&drv_sRxTelegram, drv_iRxFrameSize + SER_CRC_LEN );
+      ABCC_TRACE_UART_RX( &drv_sRxTelegram, drv_iRxFrameSize + SER_CRC_LEN );
 
-      iReceivedCrc = CRC_Crc16( (UINT8*)&drv_sRxTelegram, drv_iRxFrameSize );
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+      /*
+      ** Use the CRC calculated during reception if the physical layer has
+      ** reported the complete telegram.
+      */
+      if( drv_iRxCrcNumBytes == drv_iRxFrameSize )
+      {
+         iReceivedCrc = drv_iRxCrc;
+      }
+      else
+#endif
+      {
+         iReceivedCrc = CRC_Crc16( (UINT8*)&drv_sRxTelegram, drv_iRxFrameSize );
+      }
 
       /*
       ** Read the CRC that is sent with the telegram.
@@ -550,6 +767,9 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
             drv_iCrcErrorCount,
             "CRC check failed for received message (error count: %" PRIu16 ")\n",
             drv_iCrcErrorCount );
+#if ABCC_CFG_SERIAL_RX_STREAMING_CRC_ENABLED
+         drv_RxCrcRestart();
+#endif
          ABCC_HAL_SerRestart();
          return( NULL );
       }
@@ -565,6 +785,18 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
       ABCC_TimerStop( xTelegramTmoHandle );
       fTelegramTmo = FALSE;
 
+#if ABCC_CFG_SERIAL_ADAPTIVE_TMO_ENABLED
+      if( fRttSample )
+      {
+         /*
+         ** Measured in microseconds and rounded up to whole milliseconds so
+         ** that sub millisecond round trips are not sampled as zero when a
+         ** microsecond port clock is available.
+         */
+         drv_UpdateTelegramTmo( ( (UINT32)ABCC_TimerGetUptimeUs() - lPingSentUs + 999 ) / 1000 );
+      }
+#endif
+
       ABCC_TimerStop( xWdTmoHandle );
       fWdTmo = FALSE;
 
@@ -595,6 +827,14 @@ ABP_MsgType* ABCC_DrvSerRunDriverRx( void )
             drv_WriteFragInit( &sTxFragHandle, 0, 0, 0 );
             psWriteMsg = drv_psWriteMessage;
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+            /*
+            ** Frame boundary after a write remap response, the next ping uses
+            ** the new sizes.
+            */
+            drv_SwitchPdLayout( psWriteMsg );
+#endif
+
             /*
             ** Update the application flow control.
             */
@@ -752,7 +992,18 @@ void ABCC_DrvSerSetAppStatus( ABP_AppStatusType eAppStatus )
    (void)eAppStatus;
 }
 
-void ABCC_DrvSerSetPdSize( const UINT16  iReadPdSize, const UINT16  iWritePdSize )
+/*------------------------------------------------------------------------------
+** Checks that the PD sizes can be handled in serial operating mode.
+**------------------------------------------------------------------------------
+** Arguments:
+**       iReadPdSize:   Size of read process data (bytes)
+**       iWritePdSize:  Size of write process data (bytes)
+**
+** Returns:
+**       TRUE if the sizes are valid.
+**------------------------------------------------------------------------------
+*/
+static BOOL drv_IsPdSizeValid( const UINT16  iReadPdSize, const UINT16  iWritePdSize )
 {
    /*
    ** The serial application interface can't handle more than 256 bytes of PD.
@@ -766,7 +1017,7 @@ void ABCC_DrvSerSetPdSize( const UINT16  iReadPdSize, const UINT16  iWritePdSize
          iReadPdSize,
          ABP_MAX_PROCESS_DATA );
 
-      return;
+      return( FALSE );
    }
    else if( iWritePdSize > ABP_MAX_PROCESS_DATA )
    {
@@ -776,6 +1027,64 @@ void ABCC_DrvSerSetPdSize( const UINT16  iReadPdSize, const UINT16  iWritePdSize
          iWritePdSize,
          ABP_MAX_PROCESS_DATA );
 
+      return( FALSE );
+   }
+
+   return( TRUE );
+}
+
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*------------------------------------------------------------------------------
+** Applies the prepared PD sizes if psSentMsg is the remap response they wait
+** for. Called on frame boundaries only.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psSentMsg:     Message that was completely sent.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void drv_SwitchPdLayout( const ABP_MsgType* psSentMsg )
+{
+   ABCC_PORT_UseCritical();
+
+   ABCC_PORT_EnterCritical();
+   if( ( drv_sNextPdLayout.psRemapRespMsg != NULL ) &&
+       ( drv_sNextPdLayout.psRemapRespMsg == psSentMsg ) )
+   {
+      drv_iWritePdSize = drv_sNextPdLayout.iWritePdSize;
+      drv_iReadPdSize = drv_sNextPdLayout.iReadPdSize;
+      drv_iTxFrameSize = drv_sNextPdLayout.iTxFrameSize;
+      drv_iRxFrameSize = drv_sNextPdLayout.iRxFrameSize;
+      drv_sNextPdLayout.psRemapRespMsg = NULL;
+   }
+   ABCC_PORT_ExitCritical();
+}
+
+void ABCC_DrvSerPrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize )
+{
+   ABCC_PORT_UseCritical();
+
+   if( ( psRemapRespMsg != NULL ) && !drv_IsPdSizeValid( iReadPdSize, iWritePdSize ) )
+   {
+      psRemapRespMsg = NULL;
+   }
+
+   ABCC_PORT_EnterCritical();
+   drv_sNextPdLayout.iWritePdSize = iWritePdSize;
+   drv_sNextPdLayout.iReadPdSize = iReadPdSize;
+   drv_sNextPdLayout.iTxFrameSize = SER_CMD_STAT_REG_LEN + SER_MSG_FRAG_LEN + iWritePdSize;
+   drv_sNextPdLayout.iRxFrameSize = SER_CMD_STAT_REG_LEN + SER_MSG_FRAG_LEN + iReadPdSize;
+   drv_sNextPdLayout.psRemapRespMsg = psRemapRespMsg;
+   ABCC_PORT_ExitCritical();
+}
+#endif
+
+void ABCC_DrvSerSetPdSize( const UINT16  iReadPdSize, const UINT16  iWritePdSize )
+{
+   if( !drv_IsPdSizeValid( iReadPdSize, iWritePdSize ) )
+   {
       return;
    }
 
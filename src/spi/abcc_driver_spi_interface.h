@@ -167,7 +167,8 @@ EXTFUNC void ABCC_DrvSpiSetNbrOfCmds( UINT8 bNbrOfCmds );
 EXTFUNC void ABCC_DrvSpiSetAppStatus( ABP_AppStatusType eAppStatus );
 
 /*------------------------------------------------------------------------------
-** Sets the current process data size.
+** Sets the current process data size. Ignored with a warning while the sizes
+** prepared by ABCC_DrvSpiPrepareRemap() wait for the remap response.
 **------------------------------------------------------------------------------
 ** Arguments:
 **       iReadPdSize:   Size of read process data (bytes)
@@ -179,6 +180,24 @@ EXTFUNC void ABCC_DrvSpiSetAppStatus( ABP_AppStatusType eAppStatus );
 */
 EXTFUNC void ABCC_DrvSpiSetPdSize( const UINT16 iReadPdSize, const UINT16 iWritePdSize );
 
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+/*------------------------------------------------------------------------------
+** Prepares the process data sizes to use after a remap. The new sizes are
+** applied when psRemapRespMsg has been sent, see pnABCC_DrvPrepareRemap in
+** abcc_driver_interface.h.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psRemapRespMsg: Remap response message, NULL to cancel.
+**       iReadPdSize:    Size of read process data (bytes)
+**       iWritePdSize:   Size of write process data (bytes)
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+EXTFUNC void ABCC_DrvSpiPrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+#endif
+
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
 /*------------------------------------------------------------------------------
 ** Sets the new message fragment size for the SPI frame.
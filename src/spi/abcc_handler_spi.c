@@ -8,6 +8,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_SPI
+
 #include "abcc_config.h"
 
 #if ABCC_CFG_DRV_SPI_ENABLED
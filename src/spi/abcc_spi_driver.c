@@ -7,6 +7,8 @@
 ********************************************************************************
 */
 
+#define ABCC_LOG_MODULE_SEVERITY ABCC_CFG_LOG_SEVERITY_SPI
+
 #include "abcc_config.h"
 #include "abcc.h"
 
@@ -14,6 +16,7 @@
 
 #include "abcc_types.h"
 #include "abcc_log.h"
+#include "abcc_trace.h"
 #include "abcc_hardware_abstraction.h"
 #include "../abcc_timer.h"
 #include "../abcc_driver_interface.h"
@@ -164,6 +167,19 @@ typedef struct
 } drv_SpiMsgFragSizeInfoType;
 #endif // ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
 
+/*------------------------------------------------------------------------------
+** Process data layout waiting to be applied on a frame boundary.
+**------------------------------------------------------------------------------
+*/
+typedef struct
+{
+   BOOL               fPending;           /* A new layout is waiting to be applied. */
+   const ABP_MsgType* psRemapRespMsg;     /* Apply when this message is sent, NULL for next frame. */
+   UINT16             iReadPdSize;        /* Read PD size ( in words ). */
+   UINT16             iWritePdSize;       /* Write PD size ( in words ). */
+   UINT16             iPdSize;            /* PD size in spiFrame ( in words ). */
+} drv_SpiPdLayoutType;
+
 /*------------------------------------------------------------------------------
 ** Internal SPI states.
 **------------------------------------------------------------------------------
@@ -211,6 +227,10 @@ static UINT16                       spi_drv_iWritePdSize;         /* Current wri
 static UINT16                       spi_drv_iReadPdSize;          /* Current read PD size. */
 
 static UINT16                       spi_drv_iSpiFrameSize;        /* Current Spi frame size. */
+static drv_SpiPdLayoutType          spi_drv_sNextPdLayout;        /* PD layout to switch to on the next frame boundary. */
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+static drv_SpiPdLayoutType          spi_drv_sRemapPdLayout;       /* PD layout to switch to when the remap response is sent. */
+#endif
 static BOOL                         spi_drv_fRetransmit;          /* Indicate retransmission. */
 
 static drv_SpiStateType             spi_drv_eState;               /* SPI driver state. */
@@ -234,6 +254,9 @@ static void spi_drv_ResetReadFragInfo( void );
 static void spi_drv_ResetWriteFragInfo( void );
 
 static void DrvSpiSetMsgReceiverBuffer( ABP_MsgType* const psReadMsg );
+static void spi_drv_CalcPdLayout( drv_SpiPdLayoutType* psLayout, const UINT16 iReadPdSize, const UINT16 iWritePdSize );
+static void spi_drv_ApplyPdLayout( const drv_SpiPdLayoutType* psLayout );
+static void spi_drv_SwitchPdLayout( const ABP_MsgType* psSentMsg );
 
 /*------------------------------------------------------------------------------
 **  Handles preparation and transmission of the MOSI frame.
@@ -434,6 +457,7 @@ void ABCC_DrvSpiRunDriverTx( void )
       ** Send the MOSI frame.
       */
       ABCC_LOG_DEBUG_SPI_HEXDUMP_MOSI( (UINT16*)&spi_drv_sMosiFrame, spi_drv_iSpiFrameSize );
+      ABCC_TRACE_SPI_MOSI( &spi_drv_sMosiFrame, spi_drv_iSpiFrameSize );
       ABCC_HAL_SpiSendReceive( &spi_drv_sMosiFrame, &spi_drv_sMisoFrame, spi_drv_iSpiFrameSize << 1 );
    }
    else if( spi_drv_eState == SM_SPI_INIT )
@@ -474,6 +498,7 @@ ABP_MsgType* ABCC_DrvSpiRunDriverRx( void )
       }
 
       ABCC_LOG_DEBUG_SPI_HEXDUMP_MISO( (UINT16*)&spi_drv_sMisoFrame, spi_drv_iSpiFrameSize );
+      ABCC_TRACE_SPI_MISO( &spi_drv_sMisoFrame, spi_drv_iSpiFrameSize );
 
       lCalculatedCrc = CRC_Crc32( (UINT8*)&spi_drv_sMisoFrame, spi_drv_iSpiFrameSize*2 - 4 );
       lCalculatedCrc = lTOlBe( lCalculatedCrc );
@@ -550,6 +575,12 @@ ABP_MsgType* ABCC_DrvSpiRunDriverRx( void )
 
                spi_drv_ResetWriteFragInfo();
 
+               /*
+               ** Switch to a prepared PD layout waiting for this message. The
+               ** next MOSI frame is the first one using the new layout.
+               */
+               spi_drv_SwitchPdLayout( psWriteMsg );
+
                if( ( ABCC_GetLowAddrOct( ((ABP_MsgType16*)psWriteMsg)->sHeader.iCmdReserved ) & ABP_MSG_HEADER_C_BIT ) == 0 )
                {
                   spi_drv_bNbrOfCmds++;
@@ -610,6 +641,11 @@ ABP_MsgType* ABCC_DrvSpiRunDriverRx( void )
          }
       }
 
+      /*
+      ** Frame boundary, apply a PD layout set during the transaction.
+      */
+      spi_drv_SwitchPdLayout( NULL );
+
       /*
       ** Clear the valid pd for the next frame.
       */
@@ -639,6 +675,94 @@ static void spi_drv_DataReceived( void )
    spi_drv_fNewMisoReceived = TRUE;
 }
 
+/*------------------------------------------------------------------------------
+** Calculates the PD layout for the given PD sizes.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psLayout:      Layout to fill in.
+**       iReadPdSize:   Size of read process data (bytes)
+**       iWritePdSize:  Size of write process data (bytes)
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void spi_drv_CalcPdLayout( drv_SpiPdLayoutType* psLayout, const UINT16 iReadPdSize, const UINT16 iWritePdSize )
+{
+   psLayout->fPending = FALSE;
+   psLayout->psRemapRespMsg = NULL;
+   psLayout->iWritePdSize = NUM_BYTES_2_WORDS( iWritePdSize );
+   psLayout->iReadPdSize = NUM_BYTES_2_WORDS( iReadPdSize );
+
+   /*
+   ** Use the largest PD data size since the PD cannot be fragmented.
+   */
+   psLayout->iPdSize = psLayout->iWritePdSize;
+   if( psLayout->iReadPdSize > psLayout->iWritePdSize )
+   {
+      psLayout->iPdSize = psLayout->iReadPdSize;
+   }
+}
+
+/*------------------------------------------------------------------------------
+** Makes a PD layout the current one. Must not be called while a transaction
+** is in progress.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psLayout:      Layout to apply.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void spi_drv_ApplyPdLayout( const drv_SpiPdLayoutType* psLayout )
+{
+   spi_drv_iWritePdSize = psLayout->iWritePdSize;
+   spi_drv_iReadPdSize = psLayout->iReadPdSize;
+   spi_drv_iPdSize = psLayout->iPdSize;
+
+   /*
+   ** Update the CRC position and the total frame size since the process data
+   ** size might have changed.
+   */
+   spi_drv_iCrcOffset = spi_drv_iPdOffset + spi_drv_iPdSize;
+   spi_drv_iSpiFrameSize = SPI_FRAME_SIZE_EXCLUDING_DATA + spi_drv_iCrcOffset;
+   spi_drv_sMosiFrame.iPdLen = iTOiLe( spi_drv_iPdSize );
+}
+
+/*------------------------------------------------------------------------------
+** Applies the pending PD layout, if any, that waits for psSentMsg. Called on
+** frame boundaries only.
+**------------------------------------------------------------------------------
+** Arguments:
+**       psSentMsg:     Message that was completely sent in the frame, or NULL.
+**
+** Returns:
+**       None.
+**------------------------------------------------------------------------------
+*/
+static void spi_drv_SwitchPdLayout( const ABP_MsgType* psSentMsg )
+{
+   drv_SpiPdLayoutType* psLayout;
+   ABCC_PORT_UseCritical();
+
+   psLayout = &spi_drv_sNextPdLayout;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+   if( psSentMsg != NULL )
+   {
+      psLayout = &spi_drv_sRemapPdLayout;
+   }
+#endif
+
+   ABCC_PORT_EnterCritical();
+   if( psLayout->fPending && ( psLayout->psRemapRespMsg == psSentMsg ) )
+   {
+      spi_drv_ApplyPdLayout( psLayout );
+      psLayout->fPending = FALSE;
+   }
+   ABCC_PORT_ExitCritical();
+}
+
 /*------------------------------------------------------------------------------
 ** Reset the read fragmentation information.
 **------------------------------------------------------------------------------
@@ -726,6 +850,12 @@ void ABCC_DrvSpiInit( UINT8 bOpmode )
    spi_drv_iCrcOffset = NUM_BYTES_2_WORDS( ABCC_CFG_SPI_MSG_FRAG_LEN ) + SPI_DEFAULT_PD_LEN;
 #endif // ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
    spi_drv_iSpiFrameSize = SPI_FRAME_SIZE_EXCLUDING_DATA + spi_drv_iCrcOffset;
+   spi_drv_sNextPdLayout.fPending = FALSE;
+   spi_drv_sNextPdLayout.psRemapRespMsg = NULL;
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+   spi_drv_sRemapPdLayout.fPending = FALSE;
+   spi_drv_sRemapPdLayout.psRemapRespMsg = NULL;
+#endif
    spi_drv_fRetransmit = FALSE;
    spi_drv_iMsgLen = 0;
 
@@ -840,34 +970,62 @@ void ABCC_DrvSpiSetAppStatus( ABP_AppStatusType eAppStatus )
 
 void ABCC_DrvSpiSetPdSize( const UINT16  iReadPdSize, const UINT16  iWritePdSize )
 {
-   if( spi_drv_eState == SM_SPI_RDY_TO_SEND_MOSI )
-   {
-      /*
-      ** Use the largest PD data size since the PD cannot be fragmented.
-      */
-      spi_drv_iWritePdSize = NUM_BYTES_2_WORDS( iWritePdSize );
-      spi_drv_iReadPdSize = NUM_BYTES_2_WORDS( iReadPdSize );
+   drv_SpiPdLayoutType sLayout;
+   ABCC_PORT_UseCritical();
 
-      spi_drv_iPdSize = spi_drv_iWritePdSize;
-      if( spi_drv_iReadPdSize > spi_drv_iWritePdSize )
-      {
-         spi_drv_iPdSize = spi_drv_iReadPdSize;
-      }
+   spi_drv_CalcPdLayout( &sLayout, iReadPdSize, iWritePdSize );
 
+   ABCC_PORT_EnterCritical();
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+   if( spi_drv_sRemapPdLayout.fPending )
+   {
       /*
-      ** Update the CRC position and the total frame size since the process data
-      ** size might have changed.
+      ** The layout prepared for the remap must be applied when the remap
+      ** response is sent, the sizes cannot be changed until then.
       */
-      spi_drv_iCrcOffset = spi_drv_iPdOffset + spi_drv_iPdSize;
-      spi_drv_iSpiFrameSize = SPI_FRAME_SIZE_EXCLUDING_DATA + spi_drv_iCrcOffset;
-      spi_drv_sMosiFrame.iPdLen = iTOiLe( spi_drv_iPdSize );
+      ABCC_PORT_ExitCritical();
+      ABCC_LOG_WARNING( ABCC_EC_INCORRECT_STATE,
+         0,
+         "Process data size cannot be set while a remap is pending\n" );
+      return;
+   }
+#endif
+   if( spi_drv_eState != SM_SPI_WAITING_FOR_MISO )
+   {
+      spi_drv_sNextPdLayout.fPending = FALSE;
+      spi_drv_ApplyPdLayout( &sLayout );
    }
    else
    {
-      ABCC_LOG_WARNING( ABCC_EC_SPI_OP_NOT_ALLOWED_DURING_SPI_TRANSACTION,
-         (UINT32)spi_drv_eState, "Set PD size operation not allowed in this state (state: %d)\n", spi_drv_eState );
+      /*
+      ** The frame in progress must keep its layout. Switch on the frame
+      ** boundary instead of refusing the new size.
+      */
+      sLayout.fPending = TRUE;
+      spi_drv_sNextPdLayout = sLayout;
    }
+   ABCC_PORT_ExitCritical();
+}
+
+#if ABCC_CFG_REMAP_SUPPORT_ENABLED
+void ABCC_DrvSpiPrepareRemap( const ABP_MsgType* psRemapRespMsg, const UINT16 iReadPdSize, const UINT16 iWritePdSize )
+{
+   drv_SpiPdLayoutType sLayout;
+   ABCC_PORT_UseCritical();
+
+   spi_drv_CalcPdLayout( &sLayout, iReadPdSize, iWritePdSize );
+   sLayout.fPending = ( psRemapRespMsg != NULL );
+   sLayout.psRemapRespMsg = psRemapRespMsg;
+
+   /*
+   ** A layout waiting for the frame boundary is kept. It is applied before
+   ** the remap response can have been sent.
+   */
+   ABCC_PORT_EnterCritical();
+   spi_drv_sRemapPdLayout = sLayout;
+   ABCC_PORT_ExitCritical();
 }
+#endif
 
 #if ABCC_CFG_SPI_DYNAMIC_MSG_FRAG_LEN
 ABCC_ErrorCodeType ABCC_DrvSpiNewMsgFragSize( const UINT16 iReqMsgFragSize )
@@ -0,0 +1,670 @@
+#!/usr/bin/env python3
+################################################################################
+# Copyright 2025-present HMS Industrial Networks AB.
+# Licensed under the MIT License.
+################################################################################
+# File Description:
+# Offline generator for the ADI entry list (AD_AdiEntryType) and the default
+# process data map (AD_MapType) used by the Anybus CompactCom Driver.
+#
+# The generator reads a declarative JSON description of the ADIs and the
+# default map, validates it and writes two files:
+#
+#  <output>.h - Process data layout constants (offsets and sizes in bits and
+#               octets). The constants do not depend on any other header and
+#               can be used both by the application and by abcc_driver_config.h
+#               (e.g. to set ABCC_CFG_MAX_PROCESS_DATA_SIZE to the exact size
+#               of the map). The table declarations are only made visible if
+#               abcc_application_data_interface.h has been included first.
+#  <output>.c - The ADI entry list, the structured data type descriptions and
+#               the default map, together with compile time checks against
+#               the driver configuration (e.g. ABCC_CFG_MAX_PROCESS_DATA_SIZE).
+#
+# Errors the driver would otherwise only find at runtime (unsorted or
+# duplicated instances, unknown instances in the map, misaligned data, oversize
+# process data) are reported by the generator instead.
+#
+# Usage:
+#    abcc_adi_gen.py <description.json> -o <output path without extension>
+#
+# Description format (all keys not marked as optional are mandatory):
+#
+#  {
+#     "prefix":       "APPL",                  (optional, constant prefix)
+#     "adi_list":     "AD_asADIEntryList",     (optional, table name)
+#     "default_map":  "AD_asDefaultMap",       (optional, table name)
+#     "includes":     [ "appl_adi_data.h" ],   (optional, extra includes)
+#     "max_pd_size":  256,                     (optional, octets, checked now)
+#     "config":                                (optional, inferred from use)
+#     {
+#        "struct":        false,  ABCC_CFG_STRUCT_DATA_TYPE_ENABLED
+#        "get_set_cb":    false,  ABCC_CFG_ADI_GET_SET_CALLBACK_ENABLED
+#        "trans_set_cb":  false   ABCC_CFG_ADI_TRANS_SET_CALLBACK_ENABLED
+#     },
+#     "adis":
+#     [
+#        {
+#           "instance":  1,
+#           "name":      "Speed",
+#           "type":      "UINT16",             (ABP_ type without prefix)
+#           "elements":  1,                    (optional, default 1)
+#           "access":    [ "get", "set", "read_pd", "write_pd" ],  (optional)
+#           "value":     "&appl_iSpeed",       (optional, C expression)
+#           "props":     "&appl_sSpeedProps",  (optional, C expression)
+#           "get_cb":    "appl_GetSpeed",      (optional)
+#           "set_cb":    "appl_SetSpeed",      (optional)
+#           "trans_set_cb": "appl_SetSpeedTransparent"  (optional)
+#        },
+#        {
+#           "instance":  10,
+#           "name":      "Status",
+#           "struct":
+#           [
+#              { "name": "Flags", "type": "BIT4", "bit_offset": 0,
+#                "value": "&appl_sStatus.bFlags" },
+#              { "type": "PAD4" },
+#              { "name": "Code", "type": "UINT16",
+#                "value": "&appl_sStatus.iCode" }
+#           ]
+#        }
+#     ],
+#     "map":
+#     [
+#        { "instance": 1,  "dir": "read" },
+#        { "instance": 10, "dir": "write", "elements": 1, "start": 0,
+#          "id": "STATUS_FLAGS" },        ("elements", "start", "id" optional)
+#        { "pad": 4,       "dir": "write" }
+#     ]
+#  }
+#
+# For each mapped ADI the constants <prefix>_PD_<RD|WR>_<id>_BIT_OFFSET and
+# <prefix>_PD_<RD|WR>_<id>_BIT_SIZE are generated. <prefix>_PD_<RD|WR>_<id>
+# _OFFSET and _SIZE (octets) are added when the item is octet aligned. The id
+# is the ADI name in upper case unless given in the map entry.
+################################################################################
+
+import argparse
+import json
+import os
+import re
+import sys
+
+#
+# Size in bits of each supported data type. The BITx and PADx sizes are added
+# below, sizes are looked up with type_bits().
+#
+DATA_TYPE_BITS = {
+   "BOOL":   8,
+   "SINT8":  8,
+   "SINT16": 16,
+   "SINT32": 32,
+   "UINT8":  8,
+   "UINT16": 16,
+   "UINT32": 32,
+   "CHAR":   8,
+   "ENUM":   8,
+   "BITS8":  8,
+   "BITS16": 16,
+   "BITS32": 32,
+   "OCTET":  8,
+   "SINT64": 64,
+   "UINT64": 64,
+   "FLOAT":  32,
+   "DOUBLE": 64,
+   "BOOL1":  1,
+}
+
+for _n in range( 1, 8 ):
+   DATA_TYPE_BITS[ "BIT%d" % _n ] = _n
+
+for _n in range( 0, 17 ):
+   DATA_TYPE_BITS[ "PAD%d" % _n ] = _n
+
+#
+# Data types that require a driver configuration to be enabled.
+#
+DATA_TYPE_CONFIG = {
+   "DOUBLE": "ABCC_CFG_DOUBLE_ADI_SUPPORT_ENABLED",
+   "SINT64": "ABCC_CFG_64BIT_ADI_SUPPORT_ENABLED",
+   "UINT64": "ABCC_CFG_64BIT_ADI_SUPPORT_ENABLED",
+}
+
+ACCESS_FLAGS = {
+   "get":      "ABP_APPD_DESCR_GET_ACCESS",
+   "set":      "ABP_APPD_DESCR_SET_ACCESS",
+   "read_pd":  "ABP_APPD_DESCR_MAPPABLE_READ_PD",
+   "write_pd": "ABP_APPD_DESCR_MAPPABLE_WRITE_PD",
+}
+
+DEFAULT_ACCESS = [ "get", "set", "read_pd", "write_pd" ]
+
+CONFIG_FLAGS = [
+   ( "struct",       "ABCC_CFG_STRUCT_DATA_TYPE_ENABLED" ),
+   ( "get_set_cb",   "ABCC_CFG_ADI_GET_SET_CALLBACK_ENABLED" ),
+   ( "trans_set_cb", "ABCC_CFG_ADI_TRANS_SET_CALLBACK_ENABLED" ),
+]
+
+DIRECTIONS = {
+   "read":  ( "PD_READ",  "RD", "read_pd" ),
+   "write": ( "PD_WRITE", "WR", "write_pd" ),
+}
+
+
+class GenError( Exception ):
+   pass
+
+
+def is_bit_type( data_type ):
+   return data_type == "BOOL1" or re.match( r"^(BIT[1-7]|PAD\d+)$", data_type ) is not None
+
+
+def is_pad_type( data_type ):
+   return data_type.startswith( "PAD" )
+
+
+def type_bits( data_type, where ):
+   if data_type not in DATA_TYPE_BITS:
+      raise GenError( "%s: unknown data type '%s'" % ( where, data_type ) )
+   return DATA_TYPE_BITS[ data_type ]
+
+
+def identifier( name ):
+   ident = re.sub( r"[^A-Za-z0-9]+", "_", name ).strip( "_" ).upper()
+   if not ident or ident[ 0 ].isdigit():
+      ident = "_" + ident
+   return ident
+
+
+def c_string( text ):
+   if text is None:
+      return "NULL"
+   return '"' + text.replace( "\\", "\\\\" ).replace( '"', '\\"' ) + '"'
+
+
+def descriptor( access, where ):
+   if isinstance( access, str ):
+      return access, None
+   flags = []
+   for flag in access:
+      if flag not in ACCESS_FLAGS:
+         raise GenError( "%s: unknown access flag '%s'" % ( where, flag ) )
+      flags.append( ACCESS_FLAGS[ flag ] )
+   if not flags:
+      return "0", set()
+   return "( " + " | ".join( flags ) + " )", set( access )
+
+
+class Element:
+   """One element (array element or struct member) of an ADI."""
+
+   def __init__( self, data_type, bits, access_set ):
+      self.data_type = data_type
+      self.bits = bits
+      self.access_set = access_set
+
+
+class Adi:
+
+   def __init__( self, desc, index ):
+      where = "adis[%d]" % index
+
+      if "instance" not in desc:
+         raise GenError( "%s: missing 'instance'" % where )
+
+      self.instance = desc[ "instance" ]
+      if not isinstance( self.instance, int ) or not ( 1 <= self.instance <= 0xFFFF ):
+         raise GenError( "%s: instance must be in the range 1-65535" % where )
+
+      where = "ADI %d" % self.instance
+      self.where = where
+      self.name = desc.get( "name" )
+      self.ident = identifier( self.name if self.name else "ADI%d" % self.instance )
+      self.get_cb = desc.get( "get_cb" )
+      self.set_cb = desc.get( "set_cb" )
+      self.trans_set_cb = desc.get( "trans_set_cb" )
+      self.elements = []
+      self.members = None
+
+      if "struct" in desc:
+         self.members = []
+         bit_pos = 0
+
+         if not desc[ "struct" ] or len( desc[ "struct" ] ) > 255:
+            raise GenError( "%s: a structure must have 1-255 members" % where )
+
+         for member_index, member in enumerate( desc[ "struct" ] ):
+            member_where = "%s member %d" % ( where, member_index )
+            data_type = member.get( "type" )
+            bits = type_bits( data_type, member_where )
+            num_sub_elem = member.get( "elements", 1 )
+            bit_offset = member.get( "bit_offset", bit_pos % 8 )
+            descr, access_set = descriptor( member.get( "access", DEFAULT_ACCESS ),
+                                            member_where )
+
+            if num_sub_elem != 1 and data_type not in ( "CHAR", "OCTET" ):
+               raise GenError( "%s: only CHAR and OCTET members can have more than one sub element"
+                               % member_where )
+            if not ( 1 <= num_sub_elem <= 0xFFFF ):
+               raise GenError( "%s: number of sub elements must be in the range 1-65535"
+                               % member_where )
+            if not ( 0 <= bit_offset <= 7 ):
+               raise GenError( "%s: bit offset must be within an octet (0-7)" % member_where )
+            if not is_bit_type( data_type ) and ( bit_pos % 8 ) != 0:
+               raise GenError( "%s: %s must start on an octet boundary, it starts at bit %d of the structure "
+                               "(add padding before it)" % ( member_where, data_type, bit_pos ) )
+            if member.get( "value" ) is not None and bit_offset != bit_pos % 8:
+               raise GenError( "%s: bit offset %d does not match the packed position (bit %d of an octet)"
+                               % ( member_where, bit_offset, bit_pos % 8 ) )
+
+            self.members.append( {
+               "name":       member.get( "name" ),
+               "type":       data_type,
+               "elements":   num_sub_elem,
+               "desc":       descr,
+               "bit_offset": bit_offset,
+               "value":      member.get( "value" ),
+               "props":      member.get( "props" ),
+            } )
+            self.elements.append( Element( data_type, bits * num_sub_elem, access_set ) )
+            bit_pos += bits * num_sub_elem
+
+         self.data_type = "BOOL"
+         self.num_elements = len( self.members )
+         self.descr = "0"
+      else:
+         self.data_type = desc.get( "type" )
+         if self.data_type is None:
+            raise GenError( "%s: missing 'type'" % where )
+         bits = type_bits( self.data_type, where )
+         if is_pad_type( self.data_type ):
+            raise GenError( "%s: PAD types can only be used in structures" % where )
+
+         self.num_elements = desc.get( "elements", 1 )
+         if not isinstance( self.num_elements, int ) or not ( 1 <= self.num_elements <= 255 ):
+            raise GenError( "%s: number of elements must be in the range 1-255" % where )
+
+         self.descr, access_set = descriptor( desc.get( "access", DEFAULT_ACCESS ), where )
+         self.value = desc.get( "value" )
+         self.props = desc.get( "props" )
+         self.elements = [ Element( self.data_type, bits, access_set ) ] * self.num_elements
+
+   def types( self ):
+      if self.members is not None:
+         return [ member[ "type" ] for member in self.members ]
+      return [ self.data_type ]
+
+
+class MapItem:
+
+   def __init__( self, desc, index, adi_by_instance ):
+      where = "map[%d]" % index
+
+      if desc.get( "dir" ) not in DIRECTIONS:
+         raise GenError( "%s: 'dir' must be 'read' or 'write'" % where )
+
+      self.direction = desc[ "dir" ]
+      self.adi = None
+      self.where = where
+      self.ident = desc.get( "id" )
+
+      if "pad" in desc:
+         self.num_elem = desc[ "pad" ]
+         self.start = 0
+         if not isinstance( self.num_elem, int ) or not ( 1 <= self.num_elem <= 255 ):
+            raise GenError( "%s: number of pad bits must be in the range 1-255" % where )
+         self.elements = [ Element( "PAD1", 1, None ) ] * self.num_elem
+         return
+
+      instance = desc.get( "instance" )
+      if instance not in adi_by_instance:
+         raise GenError( "%s: instance %s doesn't exist" % ( where, instance ) )
+
+      self.adi = adi_by_instance[ instance ]
+      self.num_elem = desc.get( "elements", 0 )
+      self.start = desc.get( "start", 0 )
+
+      if self.num_elem == 0:
+         if self.start != 0:
+            raise GenError( "%s: 'start' requires 'elements'" % where )
+         item_elements = self.adi.elements
+      else:
+         if self.start < 0 or self.start + self.num_elem > self.adi.num_elements:
+            raise GenError( "%s: elements %d-%d are outside ADI %d (%d elements)"
+                            % ( where, self.start, self.start + self.num_elem - 1,
+                                instance, self.adi.num_elements ) )
+         item_elements = self.adi.elements[ self.start:self.start + self.num_elem ]
+
+      flag = DIRECTIONS[ self.direction ][ 2 ]
+      for elem in item_elements:
+         if elem.access_set is not None and not is_pad_type( elem.data_type ) and \
+            flag not in elem.access_set:
+            raise GenError( "%s: ADI %d is not mappable as %s process data"
+                            % ( where, instance, self.direction ) )
+
+      self.elements = item_elements
+
+      if self.ident is None:
+         self.ident = self.adi.ident
+         if self.num_elem != 0:
+            self.ident += "_E%d" % self.start
+      self.ident = identifier( self.ident )
+
+
+class Description:
+
+   def __init__( self, desc ):
+      self.prefix = identifier( desc.get( "prefix", "ADI" ) )
+      self.adi_list = desc.get( "adi_list", "AD_asADIEntryList" )
+      self.default_map = desc.get( "default_map", "AD_asDefaultMap" )
+      self.includes = desc.get( "includes", [] )
+      self.max_pd_size = desc.get( "max_pd_size" )
+      self.adis = []
+      self.map_items = []
+      self.warnings = []
+
+      adi_by_instance = {}
+      prev_instance = 0
+      for index, adi_desc in enumerate( desc.get( "adis", [] ) ):
+         adi = Adi( adi_desc, index )
+         if adi.instance in adi_by_instance:
+            raise GenError( "ADI %d: duplicated instance" % adi.instance )
+         if adi.instance < prev_instance:
+            raise GenError( "ADI %d: instances must be sorted in ascending order (follows ADI %d)"
+                            % ( adi.instance, prev_instance ) )
+         prev_instance = adi.instance
+         adi_by_instance[ adi.instance ] = adi
+         self.adis.append( adi )
+
+      if not self.adis:
+         raise GenError( "no ADIs described" )
+
+      if len( self.adis ) > 0xFFFF:
+         raise GenError( "too many ADIs (%d)" % len( self.adis ) )
+
+      config = desc.get( "config", {} )
+      self.config = {
+         "struct":       config.get( "struct",
+                                     any( a.members is not None for a in self.adis ) ),
+         "get_set_cb":   config.get( "get_set_cb",
+                                     any( a.get_cb or a.set_cb for a in self.adis ) ),
+         "trans_set_cb": config.get( "trans_set_cb",
+                                     any( a.trans_set_cb for a in self.adis ) ),
+      }
+      if not self.config[ "struct" ] and any( a.members is not None for a in self.adis ):
+         raise GenError( "structured ADIs are described but config 'struct' is false" )
+      if not self.config[ "get_set_cb" ] and any( a.get_cb or a.set_cb for a in self.adis ):
+         raise GenError( "get/set callbacks are described but config 'get_set_cb' is false" )
+      if not self.config[ "trans_set_cb" ] and any( a.trans_set_cb for a in self.adis ):
+         raise GenError( "transparent set callbacks are described but config 'trans_set_cb' is false" )
+
+      self.required_config = sorted( set( DATA_TYPE_CONFIG[ t ]
+                                          for a in self.adis
+                                          for t in a.types()
+                                          if t in DATA_TYPE_CONFIG ) )
+
+      self.bit_sizes = { "read": 0, "write": 0 }
+      ids = set()
+      for index, item_desc in enumerate( desc.get( "map", [] ) ):
+         item = MapItem( item_desc, index, adi_by_instance )
+         bit_pos = self.bit_sizes[ item.direction ]
+
+         item.bit_offset = bit_pos
+         for elem in item.elements:
+            if not is_bit_type( elem.data_type ) and ( bit_pos % 8 ) != 0:
+               raise GenError( "%s: %s data starts at bit %d of the %s process data, it must be "
+                               "octet aligned (add padding before it)"
+                               % ( item.where, elem.data_type, bit_pos, item.direction ) )
+            bit_pos += elem.bits
+         item.bit_size = bit_pos - item.bit_offset
+         self.bit_sizes[ item.direction ] = bit_pos
+
+         if item.adi is not None:
+            key = ( item.direction, item.ident )
+            if key in ids:
+               raise GenError( "%s: constant id '%s' is used twice for %s process data, set 'id'"
+                               % ( item.where, item.ident, item.direction ) )
+            ids.add( key )
+
+         self.map_items.append( item )
+
+      for direction in ( "read", "write" ):
+         bits = self.bit_sizes[ direction ]
+         if bits % 8:
+            self.warnings.append( "%s process data ends at bit %d, consider padding it with "
+                                  "%d bits to an octet boundary" % ( direction, bits, 8 - bits % 8 ) )
+         if self.max_pd_size is not None and ( bits + 7 ) // 8 > self.max_pd_size:
+            raise GenError( "%s process data is %d octets, max_pd_size is %d"
+                            % ( direction, ( bits + 7 ) // 8, self.max_pd_size ) )
+
+
+def banner( file_name, description, source ):
+   return (
+      "/*******************************************************************************\n"
+      "** Generated by abcc_adi_gen.py from %s.\n"
+      "** Do not edit, changes are lost when the file is regenerated.\n"
+      "********************************************************************************\n"
+      "** File Description:\n"
+      "** %s\n"
+      "********************************************************************************\n"
+      "*/\n" % ( source, description ) )
+
+
+def define( name, value ):
+   return "#define %-47s ( %s )\n" % ( name, value )
+
+
+def header_text( gen_desc, base_name, source ):
+   guard = identifier( os.path.basename( base_name ) ) + "_H_"
+   tables_guard = identifier( os.path.basename( base_name ) ) + "_TABLES_H_"
+   pfx = gen_desc.prefix
+   out = []
+
+   out.append( banner( os.path.basename( base_name ) + ".h",
+                       "ADI instances and process data layout constants.", source ) )
+   out.append( "\n#ifndef %s\n#define %s\n\n" % ( guard, guard ) )
+
+   out.append( "/*------------------------------------------------------------------------------\n"
+               "** Number of ADIs and ADI instance numbers.\n"
+               "**------------------------------------------------------------------------------\n"
+               "*/\n" )
+   out.append( define( pfx + "_NUM_ADIS", len( gen_desc.adis ) ) )
+   for adi in gen_desc.adis:
+      out.append( define( "%s_ADI_%s" % ( pfx, adi.ident ), adi.instance ) )
+
+   for direction in ( "read", "write" ):
+      short = DIRECTIONS[ direction ][ 1 ]
+      bits = gen_desc.bit_sizes[ direction ]
+      out.append( "\n/*------------------------------------------------------------------------------\n"
+                  "** %s process data layout.\n"
+                  "** Offsets are counted from the start of the %s process data buffer.\n"
+                  "**------------------------------------------------------------------------------\n"
+                  "*/\n" % ( direction.capitalize(), "RdPd" if direction == "read" else "WrPd" ) )
+      out.append( define( "%s_PD_%s_BIT_SIZE" % ( pfx, direction.upper() ), bits ) )
+      out.append( define( "%s_PD_%s_SIZE" % ( pfx, direction.upper() ), ( bits + 7 ) // 8 ) )
+
+      for item in gen_desc.map_items:
+         if item.direction != direction or item.adi is None:
+            continue
+         const_base = "%s_PD_%s_%s" % ( pfx, short, item.ident )
+         out.append( "\n" )
+         out.append( define( const_base + "_BIT_OFFSET", item.bit_offset ) )
+         out.append( define( const_base + "_BIT_SIZE", item.bit_size ) )
+         if item.bit_offset % 8 == 0 and item.bit_size % 8 == 0:
+            out.append( define( const_base + "_OFFSET", item.bit_offset // 8 ) )
+            out.append( define( const_base + "_SIZE", item.bit_size // 8 ) )
+
+   out.append( "\n/*------------------------------------------------------------------------------\n"
+               "** Largest process data size in either direction, in octets. Can be used to\n"
+               "** set ABCC_CFG_MAX_PROCESS_DATA_SIZE in abcc_driver_config.h.\n"
+               "**------------------------------------------------------------------------------\n"
+               "*/\n" )
+   out.append( define( pfx + "_PD_MAX_SIZE",
+                       max( ( gen_desc.bit_sizes[ "read" ] + 7 ) // 8,
+                            ( gen_desc.bit_sizes[ "write" ] + 7 ) // 8 ) ) )
+   out.append( "\n#endif  /* inclusion lock */\n" )
+
+   out.append( "\n/*------------------------------------------------------------------------------\n"
+               "** Generated tables. Only declared if abcc_application_data_interface.h has\n"
+               "** been included, so that the constants above can be used from\n"
+               "** abcc_driver_config.h.\n"
+               "**------------------------------------------------------------------------------\n"
+               "*/\n" )
+   out.append( "#if defined( ABCC_AD_IF_H_ ) && !defined( %s )\n#define %s\n"
+               % ( tables_guard, tables_guard ) )
+   out.append( "extern const AD_AdiEntryType %s[ %s_NUM_ADIS ];\n" % ( gen_desc.adi_list, pfx ) )
+   out.append( "extern const AD_MapType %s[];\n" % gen_desc.default_map )
+   out.append( "#endif\n" )
+
+   return "".join( out )
+
+
+def source_text( gen_desc, base_name, source ):
+   pfx = gen_desc.prefix
+   config = gen_desc.config
+   out = []
+
+   out.append( banner( os.path.basename( base_name ) + ".c",
+                       "ADI entry list and default process data map.", source ) )
+   out.append( "\n#include \"abcc_config.h\"\n"
+               "#include \"abcc_types.h\"\n"
+               "#include \"abp.h\"\n"
+               "#include \"abcc_application_data_interface.h\"\n" )
+   for include in gen_desc.includes:
+      out.append( "#include \"%s\"\n" % include )
+   out.append( "#include \"%s.h\"\n" % os.path.basename( base_name ) )
+
+   out.append( "\n/*------------------------------------------------------------------------------\n"
+               "** Compile time checks of the driver configuration.\n"
+               "**------------------------------------------------------------------------------\n"
+               "*/\n" )
+   for key, flag in CONFIG_FLAGS:
+      flag_value = 1 if config[ key ] else 0
+      out.append( "#if ( %s != %d )\n"
+                  "    #error \"The ADI tables are generated with %s set to %d.\"\n"
+                  "#endif\n\n" % ( flag, flag_value, flag, flag_value ) )
+   for flag in gen_desc.required_config:
+      out.append( "#if !%s\n"
+                  "    #error \"The ADI tables use data types that require %s.\"\n"
+                  "#endif\n\n" % ( flag, flag ) )
+   for direction in ( "read", "write" ):
+      out.append( "#if ( %s_PD_%s_SIZE > ABCC_CFG_MAX_PROCESS_DATA_SIZE )\n"
+                  "    #error \"The %s process data map does not fit in ABCC_CFG_MAX_PROCESS_DATA_SIZE.\"\n"
+                  "#endif\n\n" % ( pfx, direction.upper(), direction ) )
+
+   for adi in gen_desc.adis:
+      if adi.members is None:
+         continue
+      out.append( "/*------------------------------------------------------------------------------\n"
+                  "** Structure members of ADI %d.\n"
+                  "**------------------------------------------------------------------------------\n"
+                  "*/\n" % adi.instance )
+      out.append( "static const AD_StructDataType %s_Struct%d[] =\n{\n"
+                  % ( gen_desc.adi_list, adi.instance ) )
+      rows = []
+      for index, member in enumerate( adi.members ):
+         rows.append( "   /* Index: %d */ {  %s,  ABP_%s,  %d,  %s,  %d,  { {  %s,  %s  } } }"
+                      % ( index,
+                          c_string( member[ "name" ] ),
+                          member[ "type" ],
+                          member[ "elements" ],
+                          member[ "desc" ],
+                          member[ "bit_offset" ],
+                          member[ "value" ] or "NULL",
+                          member[ "props" ] or "NULL" ) )
+      out.append( ",\n".join( rows ) + "\n};\n\n" )
+
+   out.append( "/*------------------------------------------------------------------------------\n"
+               "** ADI entry list, sorted in ascending instance order.\n"
+               "**------------------------------------------------------------------------------\n"
+               "*/\n" )
+   out.append( "const AD_AdiEntryType %s[ %s_NUM_ADIS ] =\n{\n" % ( gen_desc.adi_list, pfx ) )
+   rows = []
+   for adi in gen_desc.adis:
+      if adi.members is not None:
+         value = "{ {  NULL,  NULL  } }"
+         struct_name = "%s_Struct%d" % ( gen_desc.adi_list, adi.instance )
+      else:
+         value = "{ {  %s,  %s  } }" % ( adi.value or "NULL", adi.props or "NULL" )
+         struct_name = "NULL"
+      fields = [ str( adi.instance ),
+                 c_string( adi.name ),
+                 "ABP_" + adi.data_type,
+                 str( adi.num_elements ),
+                 adi.descr,
+                 value ]
+      if config[ "struct" ]:
+         fields.append( struct_name )
+      if config[ "get_set_cb" ]:
+         fields.append( adi.get_cb or "NULL" )
+         fields.append( adi.set_cb or "NULL" )
+      if config[ "trans_set_cb" ]:
+         fields.append( adi.trans_set_cb or "NULL" )
+      rows.append( "   {  " + ",  ".join( fields ) + "  }" )
+   out.append( ",\n".join( rows ) + "\n};\n\n" )
+
+   out.append( "/*------------------------------------------------------------------------------\n"
+               "** Default process data map, terminated by AD_MAP_END_ENTRY.\n"
+               "**------------------------------------------------------------------------------\n"
+               "*/\n" )
+   out.append( "const AD_MapType %s[] =\n{\n" % gen_desc.default_map )
+   for item in gen_desc.map_items:
+      direction = DIRECTIONS[ item.direction ][ 0 ]
+      if item.adi is None:
+         out.append( "   {  AD_MAP_PAD_ADI,  %s,  %d,  0  },  /* %d pad bits at bit offset %d */\n"
+                     % ( direction, item.num_elem, item.num_elem, item.bit_offset ) )
+      else:
+         out.append( "   {  %d,  %s,  %s,  %d  },  /* %s_PD_%s_%s */\n"
+                     % ( item.adi.instance,
+                         direction,
+                         str( item.num_elem ) if item.num_elem else "AD_MAP_ALL_ELEM",
+                         item.start,
+                         pfx,
+                         DIRECTIONS[ item.direction ][ 1 ],
+                         item.ident ) )
+   out.append( "   {  AD_MAP_END_ENTRY  }\n};\n" )
+
+   return "".join( out )
+
+
+def main():
+   parser = argparse.ArgumentParser(
+      description = "Generate ADI tables and process data layout constants for the "
+                    "Anybus CompactCom Driver." )
+   parser.add_argument( "description", help = "JSON ADI description" )
+   parser.add_argument( "-o", "--output", required = True,
+                        help = "output path without extension, <output>.h and <output>.c are written, "
+                               "missing directories are created" )
+   args = parser.parse_args()
+
+   if not os.path.basename( args.output ):
+      parser.error( "output path '%s' has no file name" % args.output )
+
+   try:
+      with open( args.description, "r" ) as stream:
+         desc = json.load( stream )
+      gen_desc = Description( desc )
+   except ( OSError, ValueError, GenError ) as err:
+      sys.stderr.write( "%s: error: %s\n" % ( args.description, err ) )
+      return 1
+
+   for warning in gen_desc.warnings:
+      sys.stderr.write( "%s: warning: %s\n" % ( args.description, warning ) )
+
+   source = os.path.basename( args.description )
+   try:
+      output_dir = os.path.dirname( args.output )
+      if output_dir:
+         os.makedirs( output_dir, exist_ok = True )
+      for ext, text in ( ( ".h", header_text( gen_desc, args.output, source ) ),
+                         ( ".c", source_text( gen_desc, args.output, source ) ) ):
+         with open( args.output + ext, "w" ) as stream:
+            stream.write( text )
+   except OSError as err:
+      sys.stderr.write( "%s: error: %s\n" % ( args.output, err ) )
+      return 1
+
+   return 0
+
+
+if __name__ == "__main__":
+   sys.exit( main() )
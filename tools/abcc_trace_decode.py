@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+################################################################################
+# Copyright 2025-present HMS Industrial Networks AB.
+# Licensed under the MIT License.
+################################################################################
+# File Description:
+# Decoder for captures written by ABCC_TraceDump() in the Anybus CompactCom
+# Driver. The capture format is documented in inc/abcc_trace.h.
+#
+# Each record is printed on one line with its timestamp (driver uptime),
+# record type and direction. Messages are decoded into their header fields
+# followed by the captured message data, frames are printed as hex.
+#
+# Usage:
+#    abcc_trace_decode.py <capture.pcap>
+################################################################################
+
+import argparse
+import struct
+import sys
+
+PCAP_MAGIC = 0xA1B2C3D4
+PCAP_LINKTYPE = 147
+PCAP_GLOBAL_HEADER = struct.Struct( "<IHHiIII" )
+PCAP_RECORD_HEADER = struct.Struct( "<IIII" )
+RECORD_HEADER = struct.Struct( "<BBH" )
+MSG_HEADER = struct.Struct( "<HHBBHBBBB" )
+
+ABP_MSG_HEADER_E_BIT = 0x80
+ABP_MSG_HEADER_C_BIT = 0x40
+ABP_MSG_HEADER_CMD_BITS = 0x3F
+
+TYPE_MSG_TX = 0x00
+TYPE_MSG_RX = 0x01
+TYPE_MSG_EVENT = 0x02
+
+RECORD_TYPES = {
+   TYPE_MSG_TX:      "MSG TX   ",
+   TYPE_MSG_RX:      "MSG RX   ",
+   TYPE_MSG_EVENT:   "MSG EVENT",
+   0x10:             "SPI MOSI ",
+   0x11:             "SPI MISO ",
+   0x20:             "UART TX  ",
+   0x21:             "UART RX  ",
+}
+
+MSG_EVENTS = {
+   0x01: "Command queued",
+   0x02: "Command queue full",
+   0x03: "Command dequeued",
+   0x04: "Response queued",
+   0x05: "Response queue full",
+   0x06: "Response dequeued",
+   0x07: "Response routed to handler",
+   0x08: "No response handler",
+}
+
+
+class DecodeError( Exception ):
+   pass
+
+
+def format_msg( data ):
+   if len( data ) < MSG_HEADER.size:
+      return "(truncated header) " + data.hex()
+
+   ( data_size, _, source_id, dest_obj, instance,
+     cmd, _, cmd_ext0, cmd_ext1 ) = MSG_HEADER.unpack_from( data )
+
+   kind = "Cmd" if cmd & ABP_MSG_HEADER_C_BIT else "Rsp"
+   if cmd & ABP_MSG_HEADER_E_BIT:
+      kind += "(err)"
+
+   text = "%s SrcId:0x%02x Obj:0x%02x Inst:0x%04x Cmd:0x%02x Ext:0x%02x%02x Size:%d" % (
+      kind, source_id, dest_obj, instance, cmd & ABP_MSG_HEADER_CMD_BITS,
+      cmd_ext1, cmd_ext0, data_size )
+
+   msg_data = data[ MSG_HEADER.size: ]
+   if msg_data:
+      text += " Data:" + msg_data.hex()
+      if len( msg_data ) < data_size:
+         text += "..."
+
+   return text
+
+
+def decode( capture, out ):
+   if len( capture ) < PCAP_GLOBAL_HEADER.size:
+      raise DecodeError( "file too short" )
+
+   ( magic, major, minor, _, _, snap_len, link_type ) = PCAP_GLOBAL_HEADER.unpack_from( capture )
+   if magic != PCAP_MAGIC:
+      raise DecodeError( "not a little endian pcap file" )
+   if ( major, minor ) != ( 2, 4 ):
+      raise DecodeError( "unsupported pcap version %d.%d" % ( major, minor ) )
+   if link_type != PCAP_LINKTYPE:
+      raise DecodeError( "unexpected link type %d" % link_type )
+
+   pos = PCAP_GLOBAL_HEADER.size
+   num_records = 0
+
+   while pos < len( capture ):
+      if len( capture ) - pos < PCAP_RECORD_HEADER.size:
+         raise DecodeError( "truncated record header at offset %d" % pos )
+
+      ( sec, usec, incl_len, orig_len ) = PCAP_RECORD_HEADER.unpack_from( capture, pos )
+      pos += PCAP_RECORD_HEADER.size
+
+      if ( incl_len < RECORD_HEADER.size ) or ( incl_len > snap_len ) or \
+         ( pos + incl_len > len( capture ) ):
+         raise DecodeError( "invalid record length %d at offset %d" % ( incl_len, pos ) )
+
+      record = capture[ pos : pos + incl_len ]
+      pos += incl_len
+
+      ( rec_type, event, _ ) = RECORD_HEADER.unpack_from( record )
+      data = record[ RECORD_HEADER.size: ]
+
+      time_text = "%02d:%02d:%02d.%06d" % ( sec // 3600, sec // 60 % 60, sec % 60, usec )
+      type_text = RECORD_TYPES.get( rec_type, "TYPE 0x%02x" % rec_type )
+
+      if rec_type in ( TYPE_MSG_TX, TYPE_MSG_RX ):
+         text = format_msg( data )
+      elif rec_type == TYPE_MSG_EVENT:
+         text = "%s: %s" % ( MSG_EVENTS.get( event, "Event 0x%02x" % event ),
+                             format_msg( data ) )
+      else:
+         text = "Size:%d %s" % ( orig_len - RECORD_HEADER.size, data.hex() )
+         if incl_len < orig_len:
+            text += "..."
+
+      out.write( "%s %s %s\n" % ( time_text, type_text, text ) )
+      num_records += 1
+
+   return num_records
+
+
+def main():
+   parser = argparse.ArgumentParser(
+      description = "Decode a trace capture written by ABCC_TraceDump()." )
+   parser.add_argument( "capture", help = "capture file" )
+   args = parser.parse_args()
+
+   try:
+      with open( args.capture, "rb" ) as stream:
+         capture = stream.read()
+      decode( capture, sys.stdout )
+   except ( OSError, DecodeError ) as err:
+      sys.stderr.write( "%s: error: %s\n" % ( args.capture, err ) )
+      return 1
+
+   return 0
+
+
+if __name__ == "__main__":
+   sys.exit( main() )